@@ -0,0 +1,220 @@
+/*
+ * @file   Async.cpp
+ * @brief  Implements the coroutine API declared in Async.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "Async.h"
+
+#include <algorithm>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+static const int EVENTBATCH = 64;   // epoll events handled per wakeup
+
+
+std::coroutine_handle<> Task::FinalAwaiter::await_suspend(Handle h) noexcept {
+    promise_type &promise = h.promise();
+    if (promise.continuation) {
+        return promise.continuation;        // back to the awaiting coroutine
+    } // end if (promise.continuation)
+    if (promise.live != NULL) {
+        --*promise.live;                    // a spawned task is done
+        h.destroy();
+    } // end if (promise.live != NULL)
+    return std::noop_coroutine();
+} // end Task::FinalAwaiter::await_suspend(Handle)
+
+
+// Connection -----------------------------------------------------------------
+
+bool Connection::SendAwaiter::await_ready() {
+    if (!conn.sendWaiters.empty() || !conn.sender.canSend()) {
+        return false;
+    } // end if (!conn.sendWaiters.empty()...)
+    seq = conn.sender.send(msg, length);
+    return true;
+} // end Connection::SendAwaiter::await_ready()
+
+void Connection::SendAwaiter::await_suspend(std::coroutine_handle<> h) {
+    conn.sendWaiters.push_back(this);
+    waiter = h;
+} // end Connection::SendAwaiter::await_suspend(std::coroutine_handle<>)
+
+bool Connection::RecvAwaiter::await_ready() {
+    return (length = conn.receiver.deliver(msg)) >= 0;
+} // end Connection::RecvAwaiter::await_ready()
+
+void Connection::RecvAwaiter::await_suspend(std::coroutine_handle<> h) {
+    conn.recvWaiter = this;
+    waiter = h;
+} // end Connection::RecvAwaiter::await_suspend(std::coroutine_handle<>)
+
+void Connection::FlushAwaiter::await_suspend(std::coroutine_handle<> h) {
+    conn.flushWaiter = h;
+} // end Connection::FlushAwaiter::await_suspend(std::coroutine_handle<>)
+
+void Connection::LingerAwaiter::await_suspend(std::coroutine_handle<> h) {
+    conn.lingerWaiter = h;
+    conn.quiet        = quiet;
+    conn.lastHeard    = TimerClock::now();
+} // end Connection::LingerAwaiter::await_suspend(std::coroutine_handle<>)
+
+
+/**
+ * Opens the socket on port and registers it with loop.
+ * @param  loop  event loop that will drive this connection.
+ * @param  port  UDP port, shared with the peer as UdpSocket expects.
+ * @param  windowSize  frames that may be in transit each way.
+ */
+Connection::Connection(EventLoop &loop, int port, int windowSize)
+    : loop(loop), sock(port), sender(sock, windowSize),
+      receiver(sock, windowSize), recvWaiter(NULL), quiet(0), lastHeard(0) {
+    loop.add(this);
+} // end Connection(EventLoop&, int, int)
+
+Connection::~Connection() {
+    loop.remove(this);
+} // end ~Connection()
+
+
+/**
+ * Drains the socket, handing acks to the sender and frames to the
+ *  receiver, then wakes whoever can now proceed.
+ */
+void Connection::onReadable() {
+    static thread_local char msgs[ACKBATCH * MSGSIZE];
+    int  sizes[ACKBATCH];
+    int  received;
+    do {
+        received = sock.recvBatch(msgs, MSGSIZE, sizes, ACKBATCH);
+        for (int i = 0; i < received; ++i) {
+            char *msg = msgs + i * MSGSIZE;
+            if (sizes[i] >= (int)sizeof(AckHeader) &&
+                (((AckHeader*)msg)->flags & FRAME_ACK)) {
+                sender.onAck(*(AckHeader*)msg);
+            } else {
+                receiver.onFrame(msg, sizes[i]);
+            } // end if (sizes[i] >= sizeof(AckHeader)...)
+        } // end for (; i < received; )
+    } while (received == ACKBATCH);
+    lastHeard = TimerClock::now();
+    wake();
+} // end onReadable()
+
+
+/**
+ * Retransmits after a timeout, sends a held-back ack when due, and ends a
+ *  linger once the peer has been quiet long enough.
+ */
+void Connection::onTick() {
+    sender.checkTimeout();
+    receiver.checkAck();
+    if (lingerWaiter && TimerClock::now() - lastHeard >= quiet) {
+        loop.schedule(lingerWaiter);
+        lingerWaiter = NULL;
+    } // end if (lingerWaiter...)
+} // end onTick()
+
+
+/**
+ * Completes the operations the engines can now satisfy and queues their
+ *  coroutines on the loop.
+ */
+void Connection::wake() {
+    while (!sendWaiters.empty() && sender.canSend()) {
+        SendAwaiter *awaiter = sendWaiters.front();
+        sendWaiters.pop_front();
+        awaiter->seq = sender.send(awaiter->msg, awaiter->length);
+        loop.schedule(awaiter->waiter);
+    } // end while(!sendWaiters.empty()...)
+    if (recvWaiter != NULL &&
+        (recvWaiter->length = receiver.deliver(recvWaiter->msg)) >= 0) {
+        loop.schedule(recvWaiter->waiter);
+        recvWaiter = NULL;
+    } // end if (recvWaiter != NULL...)
+    if (flushWaiter && sender.idle()) {
+        loop.schedule(flushWaiter);
+        flushWaiter = NULL;
+    } // end if (flushWaiter...)
+} // end wake()
+
+
+// EventLoop ------------------------------------------------------------------
+
+EventLoop::EventLoop() : live(0) {
+    epfd    = epoll_create1(EPOLL_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    struct itimerspec tick;
+    tick.it_interval.tv_sec  = 0;
+    tick.it_interval.tv_nsec = TICK_USEC * 1000;
+    tick.it_value            = tick.it_interval;
+    timerfd_settime(timerFd, 0, &tick, NULL);
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.ptr = NULL;                  // NULL marks the timer
+    epoll_ctl(epfd, EPOLL_CTL_ADD, timerFd, &event);
+} // end EventLoop()
+
+EventLoop::~EventLoop() {
+    close(timerFd);
+    close(epfd);
+} // end ~EventLoop()
+
+
+/**
+ * Takes ownership of task and starts it on the next pass of run().
+ */
+void EventLoop::spawn(Task task) {
+    Task::Handle h = task.release();
+    h.promise().live = &live;
+    ++live;
+    schedule(h);
+} // end spawn(Task)
+
+
+/**
+ * Runs until every spawned task has finished.
+ */
+void EventLoop::run() {
+    struct epoll_event events[EVENTBATCH];
+    while (true) {
+        // resume everything that became ready, including what they enable
+        while (!ready.empty()) {
+            std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            h.resume();
+        } // end while(!ready.empty())
+        if (live == 0) {
+            break;
+        } // end if (live == 0)
+        int count = epoll_wait(epfd, events, EVENTBATCH, -1);
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.ptr != NULL) {
+                ((Connection*)events[i].data.ptr)->onReadable();
+                continue;
+            } // end if (events[i].data.ptr != NULL)
+            uint64_t expirations;
+            if (read(timerFd, &expirations, sizeof(expirations)) > 0) {
+                for (size_t c = 0; c < conns.size(); ++c) {
+                    conns[c]->onTick();
+                } // end for (; c < conns.size(); )
+            } // end if (read(timerFd...) > 0)
+        } // end for (; i < count; )
+    } // end while(true)
+} // end run()
+
+
+void EventLoop::add(Connection *conn) {
+    struct epoll_event event;
+    event.events   = EPOLLIN;
+    event.data.ptr = conn;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, conn->sock.getDescriptor(), &event);
+    conns.push_back(conn);
+} // end add(Connection*)
+
+void EventLoop::remove(Connection *conn) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, conn->sock.getDescriptor(), NULL);
+    conns.erase(std::find(conns.begin(), conns.end(), conn));
+} // end remove(Connection*)
@@ -0,0 +1,199 @@
+/*
+ * @file   Async.h
+ * @brief  Declares a C++20 coroutine API over the protocol engines. An
+ *          EventLoop waits on many Connections at once with epoll and steps
+ *          their engines as acks and frames arrive or timers expire, so a
+ *          coroutine writes co_await conn.send(msg, length) or co_await
+ *          conn.recv(msg) and a thread can carry thousands of transfers.
+ *          Coroutines are resumed only from the loop's ready queue, never
+ *          from inside a Connection, so one may finish and destroy its
+ *          Connection at any suspension point. A loop is not thread-safe;
+ *          run one loop per thread and give each its own Connections.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _ASYNC_H_
+#define _ASYNC_H_
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <vector>
+
+#include "Engine.h"
+
+static const long TICK_USEC = 250;  // how often timers are checked
+
+class EventLoop;
+
+/**
+ * A coroutine that starts when it is awaited or spawned on an EventLoop.
+ */
+class Task {
+ public:
+    struct promise_type;
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    /**
+     * Resumes whoever awaited the task when it finishes, or destroys the
+     *  frame of a spawned task and tells its loop.
+     */
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(Handle h) noexcept;
+        void await_resume() noexcept { }
+    };
+
+    struct promise_type {
+        std::coroutine_handle<> continuation;   // coroutine awaiting this
+        int                    *live = NULL;    // loop's count if spawned
+        Task get_return_object() { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() { }
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task &&other) : handle(other.handle) { other.handle = NULL; }
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        } // end if (handle)
+    } // end ~Task()
+
+    bool await_ready() { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) {
+        handle.promise().continuation = awaiter;
+        return handle;                      // start the task right away
+    } // end await_suspend(std::coroutine_handle<>)
+    void await_resume() { }
+
+ private:
+    friend class EventLoop;
+    explicit Task(Handle handle) : handle(handle) { }
+    Handle release() {
+        Handle h = handle;
+        handle = NULL;
+        return h;
+    } // end release()
+
+    Handle handle;      // the coroutine frame, owned until spawned
+};
+
+
+/**
+ * One reliable two-way session on its own UdpSocket. Sending uses a
+ *  Go-Back-N sender and receiving a selective repeat receiver, as test 3
+ *  does; the flags of each datagram tell acks from frames.
+ */
+class Connection {
+ public:
+    /**
+     * Resumes with the sequence number of the frame once it is sent.
+     */
+    struct SendAwaiter {
+        Connection &conn;
+        const char *msg;
+        int         length;
+        uint32_t    seq;
+        std::coroutine_handle<> waiter;
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h);
+        uint32_t await_resume() { return seq; }
+    };
+
+    /**
+     * Resumes with the byte count of the next in-order message.
+     */
+    struct RecvAwaiter {
+        Connection &conn;
+        char       *msg;
+        int         length;
+        std::coroutine_handle<> waiter;
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h);
+        int  await_resume() { return length; }
+    };
+
+    /**
+     * Resumes once every frame sent has been acknowledged.
+     */
+    struct FlushAwaiter {
+        Connection &conn;
+        bool await_ready() { return conn.sender.idle(); }
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() { }
+    };
+
+    /**
+     * Resumes once quiet usec pass with nothing arriving, answering the
+     *  peer's retransmissions meanwhile, so a receiver that has taken its
+     *  last message still re-acks frames whose acks were lost.
+     */
+    struct LingerAwaiter {
+        Connection &conn;
+        long        quiet;
+        bool await_ready() { return false; }
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() { }
+    };
+
+    Connection(EventLoop &loop, int port, int windowSize);
+    ~Connection();
+    bool setDestAddress(char ipName[]) { return sock.setDestAddress(ipName); }
+
+    SendAwaiter  send(const char msg[], int length) {
+        return SendAwaiter{ *this, msg, length, 0, NULL };
+    } // end send(const char[], int)
+    RecvAwaiter  recv(char msg[]) {
+        return RecvAwaiter{ *this, msg, -1, NULL };
+    } // end recv(char[])
+    FlushAwaiter flush() { return FlushAwaiter{ *this }; }
+    LingerAwaiter linger(long quiet) { return LingerAwaiter{ *this, quiet }; }
+    int          retransmits() const { return sender.retransmits(); }
+
+ private:
+    friend class EventLoop;
+    void onReadable();
+    void onTick();
+    void wake();
+
+    EventLoop                      &loop;
+    UdpSocket                       sock;
+    SenderEngine<GoBackN>           sender;
+    ReceiverEngine<SelectiveRepeat> receiver;
+    std::deque<SendAwaiter*>        sendWaiters;  // waiting for window room
+    RecvAwaiter                    *recvWaiter;   // waiting for a message
+    std::coroutine_handle<>         flushWaiter;  // waiting for all acks
+    std::coroutine_handle<>         lingerWaiter; // waiting for quiet
+    long                            quiet;        // usec it waits for
+    long                            lastHeard;    // when a datagram came
+};
+
+
+/**
+ * Waits on every Connection built on it and resumes coroutines whose
+ *  awaited event has happened.
+ */
+class EventLoop {
+ public:
+    EventLoop();
+    ~EventLoop();
+    void spawn(Task task);
+    void run();
+
+ private:
+    friend class Connection;
+    void add(Connection *conn);
+    void remove(Connection *conn);
+    void schedule(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    int                                  epfd;    // epoll instance
+    int                                  timerFd; // periodic tick
+    int                                  live;    // spawned tasks running
+    std::vector<Connection*>             conns;   // for the timer tick
+    std::deque<std::coroutine_handle<> > ready;   // to resume next
+};
+
+#endif
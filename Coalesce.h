@@ -0,0 +1,153 @@
+/*
+ * @file   Coalesce.h
+ * @brief  Declares a send-side coalescer that packs small messages into one
+ *          frame as length-prefixed records, and the reader that unpacks
+ *          them on the receiving side. As in Nagle's algorithm, a partial
+ *          frame goes out at once while nothing is in transit and otherwise
+ *          waits until it fills, until it has waited its delay, or until the
+ *          caller flushes it. A corked coalescer sends only full frames
+ *          until it is uncorked, for callers that write a burst of records
+ *          and want them packed whatever the window is doing.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _COALESCE_H_
+#define _COALESCE_H_
+
+#include "Engine.h"
+
+static const long NAGLE_USEC = 200; // usec a partial frame may be held
+
+template <class Sender, class Clock = TimerClock>
+class Coalescer {
+ public:
+    /**
+     * @param  sender  engine the packed frames are sent through.
+     * @param  delay  usec a partial frame may wait for more records.
+     */
+    Coalescer(Sender &sender, long delay = NAGLE_USEC)
+        : sender(sender), delay(delay), used(0), heldSince(0), corked(false),
+          packed(0) { }
+
+    /**
+     * Appends msg[] to the frame being packed, sending the frame first if
+     *  the record does not fit. Blocks only while the window is full.
+     * @param  length  bytes of msg[]; at most RECORDSIZE.
+     */
+    void write(const char msg[], int length) {
+        if (used + (int)sizeof(RecordHeader) + length > PAYLOADSIZE) {
+            flush();                        // full
+        } // end if (used + sizeof(RecordHeader)...)
+        if (used == 0) {
+            heldSince = Clock::now();
+        } // end if (used == 0)
+        ((RecordHeader*)(frame + used))->length = length;
+        memcpy(frame + used + sizeof(RecordHeader), msg, length);
+        used += sizeof(RecordHeader) + length;
+        ++packed;
+        if (!corked && sender.idle()) {
+            flush();                        // nothing in transit to wait on
+        } // end if (!corked && sender.idle())
+    } // end write(const char[], int)
+
+    /**
+     * Takes in acks, retransmits on a timeout and sends the partial frame
+     *  if it has waited long enough or nothing is left in transit.
+     */
+    void poll() {
+        sender.ackAdvance();
+        sender.checkTimeout();
+        if (used > 0 && !corked &&
+            (sender.idle() || Clock::now() - heldSince >= delay)) {
+            flush();
+        } // end if (used > 0...)
+    } // end poll()
+
+    /**
+     * Sends the records packed so far as one frame, waiting for room in
+     *  the window if need be. Does not wait for acks.
+     */
+    void flush() {
+        if (used == 0) {
+            return;
+        } // end if (used == 0)
+        while (!sender.canSend()) {
+            sender.checkTimeout();
+            sender.ackAdvance();
+        } // end while(!sender.canSend())
+        sender.send(frame, used);
+        used = 0;
+    } // end flush()
+
+    /**
+     * Holds partial frames until uncork(), whatever the window does.
+     */
+    void cork() { corked = true; }
+
+    /**
+     * Sends what was held while corked and resumes the usual rules.
+     */
+    void uncork() {
+        corked = false;
+        flush();
+    } // end uncork()
+
+    int records() const { return packed; }
+
+ private:
+    Sender &sender;                 // carries the packed frames
+    long    delay;                  // usec a partial frame may wait
+    char    frame[PAYLOADSIZE];     // records packed so far
+    int     used;                   // bytes of frame[] in use
+    long    heldSince;              // time the first record was packed
+    bool    corked;                 // whether partial frames are held
+    int     packed;                 // records written
+};
+
+
+/**
+ * Hands the records packed by a Coalescer back one at a time.
+ */
+template <class Receiver>
+class RecordReader {
+ public:
+    /**
+     * @param  receiver  engine the packed frames are delivered by.
+     */
+    RecordReader(Receiver &receiver)
+        : receiver(receiver), length(0), offset(0) { }
+
+    /**
+     * Copies the next record into msg[], taking the next frame from the
+     *  receiver when the current one is used up.
+     * @param  msg  container of at least RECORDSIZE bytes.
+     * @return Bytes of the record, or -1 if no frame is ready.
+     */
+    int read(char msg[]) {
+        while (offset + (int)sizeof(RecordHeader) > length) {
+            if ((length = receiver.deliver(frame)) < 0) {
+                length = 0;
+                offset = 0;
+                return -1;
+            } // end if ((length = receiver.deliver(frame)) < 0)
+            offset = 0;
+        } // end while(offset + sizeof(RecordHeader) > length)
+        int bytes = ((RecordHeader*)(frame + offset))->length;
+        offset += sizeof(RecordHeader);
+        if (bytes > length - offset) {
+            bytes = length - offset;        // truncated record
+        } // end if (bytes > length - offset)
+        memcpy(msg, frame + offset, bytes);
+        offset += bytes;
+        return bytes;
+    } // end read(char[])
+
+ private:
+    Receiver &receiver;             // delivers the packed frames
+    char      frame[PAYLOADSIZE];   // frame being unpacked
+    int       length;               // bytes of frame[]
+    int       offset;               // start of the next record in frame[]
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * @file   Compress.h
+ * @brief  Declares a transport that wraps another and compresses the payload
+ *          of every frame it sends with LZ4, setting FRAME_LZ4 on those that
+ *          shrank, and decompresses such frames as they are received. Acks
+ *          and frames that would not shrink pass through untouched, so
+ *          either engine runs over it unchanged and a plain peer still
+ *          understands every frame that was not compressed. The sender
+ *          watches the ratio it achieves: when a sample of frames saves too
+ *          little it stops compressing for a while, then samples again.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _COMPRESS_H_
+#define _COMPRESS_H_
+
+#include "Frame.h"
+#include "Lz4.h"
+
+static const int LZ4SAMPLE  = 64;   // frames whose ratio is judged together
+static const int LZ4BACKOFF = 1024; // frames sent plain after a poor sample
+static const int LZ4PERCENT = 90;   // wire bytes per 100 raw that are poor
+
+template <class Transport>
+class CompressSocket {
+ public:
+    /**
+     * @param  sock  transport that carries the frames.
+     * @param  enabled  false to only decompress what arrives.
+     */
+    CompressSocket(Transport &sock, bool enabled = true)
+        : sock(sock), enabled(enabled), sampled(0), sampleRaw(0), sampleWire(0), backoff(0),
+          rawBytes(0), wireBytes(0) { }
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+    int ackTo(char msg[], int length) { return sock.ackTo(msg, length); }
+
+    /**
+     * Sends a frame, compressed if that makes it smaller and compression
+     *  has not been switched off by a poor sample.
+     */
+    int sendTo(char frame[], int length) {
+        int payload = length - (int)sizeof(FrameHeader);
+        rawBytes += length;
+        if (!enabled || backoff > 0 || payload <= 0) {
+            if (backoff > 0) {
+                --backoff;
+            } // end if (backoff > 0)
+            wireBytes += length;
+            return sock.sendTo(frame, length);
+        } // end if (backoff > 0...)
+        char out[MSGSIZE];
+        int  packed = lz4Compress(frame + sizeof(FrameHeader), payload,
+                                  out + sizeof(FrameHeader), payload - 1);
+        sample(payload, packed > 0 ? packed : payload);
+        if (packed == 0) {
+            wireBytes += length;            // no smaller; send as it is
+            return sock.sendTo(frame, length);
+        } // end if (packed == 0)
+        ((FrameHeader*)out)->seq   = ((FrameHeader*)frame)->seq;
+        ((FrameHeader*)out)->flags = ((FrameHeader*)frame)->flags | FRAME_LZ4;
+        wireBytes += sizeof(FrameHeader) + packed;
+        sock.sendTo(out, sizeof(FrameHeader) + packed);
+        return length;
+    } // end sendTo(char[], int)
+
+    /**
+     * Receives a datagram, decompressing it if it is a compressed frame.
+     * @return Bytes of the datagram as sent, or -1 if it would not
+     *          decompress.
+     */
+    int recvFrom(char msg[], int length) {
+        return expand(msg, sock.recvFrom(msg, length), length);
+    } // end recvFrom(char[], int)
+
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        int received = sock.recvBatch(msgs, length, sizes, count);
+        for (int i = 0; i < received; ++i) {
+            sizes[i] = expand(msgs + i * length, sizes[i], length);
+        } // end for (; i < received; )
+        return received;
+    } // end recvBatch(char[], int, int[], int)
+
+    bool compressing() const { return enabled && backoff == 0; }
+    long raw() const { return rawBytes; }
+    long wire() const { return wireBytes; }
+
+ private:
+    /**
+     * Judges the ratio once a sample is complete and backs off if poor.
+     */
+    void sample(int raw, int wire) {
+        sampleRaw  += raw;
+        sampleWire += wire;
+        if (++sampled < LZ4SAMPLE) {
+            return;
+        } // end if (++sampled < LZ4SAMPLE)
+        if (sampleWire * 100 > sampleRaw * LZ4PERCENT) {
+            backoff = LZ4BACKOFF;
+        } // end if (sampleWire * 100 > ...)
+        sampled = 0;
+        sampleRaw = sampleWire = 0;
+    } // end sample(int, int)
+
+    /**
+     * Decompresses a compressed frame of size bytes in place.
+     * @return Bytes of the frame now in msg[], or -1 if it is corrupt.
+     */
+    int expand(char msg[], int size, int length) {
+        if (size < (int)sizeof(FrameHeader) ||
+            !(((FrameHeader*)msg)->flags & FRAME_LZ4) ||
+            (((FrameHeader*)msg)->flags & FRAME_ACK)) {
+            return size;
+        } // end if (size < sizeof(FrameHeader)...)
+        char packed[MSGSIZE];
+        int  packedLen = size - sizeof(FrameHeader);
+        memcpy(packed, msg + sizeof(FrameHeader), packedLen);
+        int  payload = lz4Decompress(packed, packedLen,
+                                     msg + sizeof(FrameHeader),
+                                     length - (int)sizeof(FrameHeader));
+        if (payload < 0) {
+            return -1;
+        } // end if (payload < 0)
+        ((FrameHeader*)msg)->flags &= ~FRAME_LZ4;
+        return sizeof(FrameHeader) + payload;
+    } // end expand(char[], int, int)
+
+    Transport &sock;        // carries the frames
+    bool       enabled;     // whether frames sent may be compressed
+    int        sampled;     // frames in the current sample
+    long       sampleRaw;   // payload bytes of the sample
+    long       sampleWire;  // those bytes as sent
+    int        backoff;     // frames left to send uncompressed
+    long       rawBytes;    // frame bytes handed to sendTo()
+    long       wireBytes;   // frame bytes that went on the wire
+};
+
+#endif
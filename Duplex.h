@@ -0,0 +1,237 @@
+/*
+ * @file   Duplex.h
+ * @brief  Declares a two-way session that runs a sender and a receiver
+ *          engine on one socket and carries the receiver's acks inside the
+ *          sender's frames. DuplexSocket sits under both engines: an ack
+ *          the receiver sends is held, and the next frame to leave takes it
+ *          along in a DuplexHeader; only an ack held longer than its delay
+ *          goes out by itself. When both ends have data to send, as in a
+ *          request/response exchange, nearly every standalone ack datagram
+ *          disappears.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _DUPLEX_H_
+#define _DUPLEX_H_
+
+#include "Engine.h"
+
+template <class Transport = UdpSocket, class Clock = TimerClock>
+class DuplexSocket {
+ public:
+    /**
+     * @param  sock  bound socket with a peer to send to.
+     * @param  delay  usec an ack may wait for a frame to ride on.
+     */
+    DuplexSocket(Transport &sock, long delay = DelayedAck::DELAY)
+        : sock(sock), delay(delay), held(false), heldAck(0), heldSince(0),
+          standalone(0), piggybacked(0) { }
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+    int recvFrom(char msg[], int length) { return sock.recvFrom(msg, length); }
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        return sock.recvBatch(msgs, length, sizes, count);
+    } // end recvBatch(char[], int, int[], int)
+
+    /**
+     * Sends a frame, with the held ack in its header if there is one. A
+     *  frame whose payload is over DUPLEXPAYLOAD bytes has no room for it,
+     *  so the ack goes out by itself first and the frame unchanged.
+     */
+    int sendTo(char frame[], int length) {
+        if (held && length > DUPLEXPAYLOAD + (int)sizeof(FrameHeader)) {
+            sendHeld();
+        } // end if (held && length > DUPLEXPAYLOAD + ...)
+        if (!held) {
+            return sock.sendTo(frame, length);
+        } // end if (!held)
+        char           out[MSGSIZE];
+        DuplexHeader  *header = (DuplexHeader*)out;
+        header->seq   = ((FrameHeader*)frame)->seq;
+        header->flags = ((FrameHeader*)frame)->flags | FRAME_PIGGY;
+        header->ack   = heldAck;
+        memcpy(out + sizeof(DuplexHeader), frame + sizeof(FrameHeader),
+               length - sizeof(FrameHeader));
+        held = false;
+        ++piggybacked;
+        return sock.sendTo(out, length + sizeof(header->ack));
+    } // end sendTo(char[], int)
+
+    /**
+     * Holds an ack for the next frame to carry. Acks are cumulative, so a
+     *  newer one replaces what is held but keeps its waiting time. Only a
+     *  plain AckHeader fits in a DuplexHeader: anything else on the ack
+     *  path, an EcnAckHeader's CE count or a NackHeader's gaps, goes out
+     *  at once as it is, after any ack held, so nothing is lost or reordered.
+     */
+    int ackTo(char msg[], int length) {
+        if (length != (int)sizeof(AckHeader) ||
+            ((AckHeader*)msg)->flags != FRAME_ACK) {
+            if (held) {
+                sendHeld();
+            } // end if (held)
+            ++standalone;
+            return sock.ackTo(msg, length);
+        } // end if (length != sizeof(AckHeader)...)
+        heldAck = ((AckHeader*)msg)->ack;
+        if (!held) {
+            held      = true;
+            heldSince = Clock::now();
+        } // end if (!held)
+        return length;
+    } // end ackTo(char[], int)
+
+    /**
+     * Sends the held ack by itself once it has waited its delay.
+     */
+    void checkAck() {
+        if (held && Clock::now() - heldSince >= delay) {
+            sendHeld();
+        } // end if (held...)
+    } // end checkAck()
+
+    bool idle() const { return !held; }
+    int  acks() const { return standalone; }
+    int  piggybacks() const { return piggybacked; }
+
+ private:
+    void sendHeld() {
+        AckHeader ack;
+        ack.ack   = heldAck;
+        ack.flags = FRAME_ACK;
+        sock.ackTo((char*)&ack, sizeof(ack));
+        held = false;
+        ++standalone;
+    } // end sendHeld()
+
+    Transport &sock;        // carries every datagram of the session
+    long       delay;       // usec an ack may be held
+    bool       held;        // whether heldAck is waiting to be sent
+    uint32_t   heldAck;     // newest ack from the receiver
+    long       heldSince;   // time the held ack was first held
+    int        standalone;  // acks sent in datagrams of their own
+    int        piggybacked; // acks sent in frames
+};
+
+
+/**
+ * One reliable session carrying frames both ways. The caller steps it
+ *  with step() while waiting, or uses the blocking calls.
+ */
+template <class Transport = UdpSocket, class Clock = TimerClock>
+class DuplexSession {
+ public:
+    typedef DuplexSocket<Transport, Clock> Link;
+    typedef SenderEngine<SelectiveRepeat, CumulativeAck, FixedWindow, Clock,
+                         Link> Sender;
+    typedef ReceiverEngine<SelectiveRepeat, CumulativeAck, Clock, Link>
+        Receiver;
+
+    /**
+     * @param  sock  bound socket with a peer to send to.
+     * @param  windowSize  frames that may be in transit each way.
+     */
+    DuplexSession(Transport &sock, int windowSize)
+        : link(sock), sender(link, windowSize), receiver(link, windowSize) { }
+
+    bool canSend() const { return sender.canSend(); }
+
+    /**
+     * Sends msg[] to the peer, stepping the session until there is room.
+     * @param  length  bytes of msg[]; at most DUPLEXPAYLOAD.
+     * @return The sequence number given to the frame.
+     */
+    uint32_t send(const char msg[], int length) {
+        while (!sender.canSend()) {
+            step();
+        } // end while(!sender.canSend())
+        return sender.send(msg, length);
+    } // end send(const char[], int)
+
+    /**
+     * Copies the next message from the peer into msg[] without waiting.
+     * @return Bytes of payload, or -1 if the next message has not arrived.
+     */
+    int deliver(char msg[]) { return receiver.deliver(msg); }
+
+    /**
+     * Steps the session until the next message from the peer arrives.
+     */
+    int receive(char msg[]) {
+        int length;
+        while ((length = receiver.deliver(msg)) < 0) {
+            step();
+        } // end while((length = receiver.deliver(msg)) < 0)
+        return length;
+    } // end receive(char[])
+
+    /**
+     * Takes in everything queued on the socket, then retransmits and acks
+     *  as the timers direct. Never blocks.
+     */
+    void step() {
+        static thread_local char msgs[ACKBATCH * MSGSIZE];
+        int  sizes[ACKBATCH];
+        int  received;
+        do {
+            received = link.recvBatch(msgs, MSGSIZE, sizes, ACKBATCH);
+            for (int i = 0; i < received; ++i) {
+                dispatch(msgs + i * MSGSIZE, sizes[i]);
+            } // end for (; i < received; )
+        } while (received == ACKBATCH);
+        sender.checkTimeout();
+        link.checkAck();
+    } // end step()
+
+    /**
+     * Hands one datagram to the engines: its ack, standalone or carried,
+     *  to the sender and its frame to the receiver.
+     */
+    void dispatch(char dgram[], int length) {
+        if (length < (int)sizeof(FrameHeader)) {
+            return;                         // runt
+        } // end if (length < sizeof(FrameHeader))
+        const uint32_t flags = ((FrameHeader*)dgram)->flags;
+        if (flags & FRAME_ACK) {
+            sender.onAck(*(AckHeader*)dgram);
+            return;
+        } // end if (flags & FRAME_ACK)
+        if (length >= (int)sizeof(DuplexHeader) && (flags & FRAME_PIGGY)) {
+            DuplexHeader *carried = (DuplexHeader*)dgram;
+            AckHeader     ack;
+            ack.ack   = carried->ack;
+            ack.flags = FRAME_ACK;
+            sender.onAck(ack);
+            // rebuild a plain FrameHeader right in front of the payload
+            FrameHeader header;
+            header.seq   = carried->seq;
+            header.flags = flags & ~FRAME_PIGGY;
+            dgram  += sizeof(DuplexHeader) - sizeof(FrameHeader);
+            length -= sizeof(DuplexHeader) - sizeof(FrameHeader);
+            memcpy(dgram, &header, sizeof(header));
+        } // end if (length >= sizeof(DuplexHeader)...)
+        receiver.onFrame(dgram, length);
+    } // end dispatch(char[], int)
+
+    /**
+     * Steps the session until every frame sent has been acknowledged and
+     *  no ack is left held.
+     */
+    void flush() {
+        while (!sender.idle() || !link.idle()) {
+            step();
+        } // end while(!sender.idle()...)
+    } // end flush()
+
+    int retransmits() const { return sender.retransmits(); }
+    int acks() const { return link.acks(); }
+    int piggybacks() const { return link.piggybacks(); }
+
+ private:
+    Link     link;          // holds acks until a frame can carry them
+    Sender   sender;        // frames to the peer
+    Receiver receiver;      // frames from the peer
+};
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * @file   Ecn.h
+ * @brief  Declares the transports that carry ECN between the engines and a
+ *          UdpSocket. EcnSocket marks every datagram it sends ECN-capable
+ *          and sets FRAME_CE on every frame that arrives marked Congestion
+ *          Experienced, so the receiver engine can count the marks and echo
+ *          them in EcnAckHeaders; the sender engine hands the count on to
+ *          its congestion controller. EcnMarker stands in for a router whose
+ *          queue marks instead of dropping, as a DCTCP switch does: every
+ *          frame sent while more than a threshold of frames are unacked is
+ *          sent marked CE, so ECN can be exercised over loopback, where no
+ *          queue marks anything by itself.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _ECN_H_
+#define _ECN_H_
+
+#include "Frame.h"
+#include "SeqSpace.h"
+
+template <class Transport = UdpSocket>
+class EcnSocket {
+ public:
+    /**
+     * @param  sock  socket that carries the frames; it must read and set
+     *                the ECN codepoint as UdpSocket does.
+     */
+    EcnSocket(Transport &sock) : sock(sock), marks(0) {
+        sock.setEcn(ECN_ECT0);
+    } // end EcnSocket(Transport&)
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+    int sendTo(char msg[], int length) { return sock.sendTo(msg, length); }
+    int ackTo(char msg[], int length) { return sock.ackTo(msg, length); }
+
+    int recvFrom(char msg[], int length) {
+        int size = sock.recvFrom(msg, length);
+        note(msg, size, 0);
+        return size;
+    } // end recvFrom(char[], int)
+
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        int received = sock.recvBatch(msgs, length, sizes, count);
+        for (int i = 0; i < received; ++i) {
+            note(msgs + i * length, sizes[i], i);
+        } // end for (; i < received; )
+        return received;
+    } // end recvBatch(char[], int, int[], int)
+
+    int marked() const { return marks; }
+
+ private:
+    /**
+     * Sets FRAME_CE on the i-th datagram just received if it is a frame
+     *  that came marked CE.
+     */
+    void note(char msg[], int size, int i) {
+        FrameHeader *header = (FrameHeader*)msg;
+        if (size >= (int)sizeof(FrameHeader) &&
+            !(header->flags & FRAME_ACK) && sock.getEcn(i) == ECN_CE) {
+            header->flags |= FRAME_CE;
+            ++marks;
+        } // end if (size >= sizeof(FrameHeader)...)
+    } // end note(char[], int, int)
+
+    Transport &sock;        // reads and sets the ECN codepoint
+    int        marks;       // frames received marked CE
+};
+
+
+template <class Transport = UdpSocket>
+class EcnMarker {
+ public:
+    /**
+     * @param  sock  socket that carries the frames, as for EcnSocket.
+     * @param  threshold  unacked frames beyond which frames are marked CE.
+     */
+    EcnMarker(Transport &sock, int threshold)
+        : sock(sock), threshold(threshold), highest(0), acked(0),
+          marks(0) {
+        sock.setEcn(ECN_ECT0);
+    } // end EcnMarker(Transport&, int)
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+    int ackTo(char msg[], int length) { return sock.ackTo(msg, length); }
+
+    /**
+     * Sends a frame, marked CE if the emulated queue is past its threshold.
+     */
+    int sendTo(char frame[], int length) {
+        const FrameHeader *header = (const FrameHeader*)frame;
+        if (length < (int)sizeof(FrameHeader) ||
+            (header->flags & FRAME_SKIP)) {
+            return sock.sendTo(frame, length);
+        } // end if (length < sizeof(FrameHeader)...)
+        if (!SeqSpace::before(header->seq, highest)) {
+            highest = header->seq + 1;
+        } // end if (!SeqSpace::before(header->seq, highest))
+        bool congested = (int)(highest - acked) > threshold;
+        marks += congested;
+        sock.setEcn(congested ? ECN_CE : ECN_ECT0);
+        return sock.sendTo(frame, length);
+    } // end sendTo(char[], int)
+
+    int recvFrom(char msg[], int length) {
+        int size = sock.recvFrom(msg, length);
+        note(msg, size);
+        return size;
+    } // end recvFrom(char[], int)
+
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        int received = sock.recvBatch(msgs, length, sizes, count);
+        for (int i = 0; i < received; ++i) {
+            note(msgs + i * length, sizes[i]);
+        } // end for (; i < received; )
+        return received;
+    } // end recvBatch(char[], int, int[], int)
+
+    int marked() const { return marks; }
+
+ private:
+    /**
+     * Drains the emulated queue up to the highest cumulative ack heard.
+     */
+    void note(const char msg[], int size) {
+        const AckHeader *ack = (const AckHeader*)msg;
+        if (size >= (int)sizeof(AckHeader) && (ack->flags & FRAME_ACK) &&
+            !(ack->flags & FRAME_NACK) && SeqSpace::before(acked, ack->ack)) {
+            acked = ack->ack;
+        } // end if (size >= sizeof(AckHeader)...)
+    } // end note(const char[], int)
+
+    Transport &sock;        // sets the ECN codepoint of each frame
+    int        threshold;   // unacked frames the queue holds unmarked
+    uint32_t   highest;     // one past the highest frame sent
+    uint32_t   acked;       // frames below it have been acked
+    int        marks;       // frames sent marked CE
+};
+
+#endif
@@ -0,0 +1,1180 @@
+/*
+ * @file   Engine.h
+ * @brief  Declares sender and receiver protocol engines that are specialized
+ *          at compile time by policy classes. Each engine is a state machine
+ *          that is stepped by its blocking transfer() loop; the policies
+ *          decide how many frames may be in transit, what is retransmitted
+ *          after a timeout, when the receiver acknowledges, how the window
+ *          responds to acks and losses, where time comes from, and which
+ *          socket carries the frames. Every policy call is resolved and
+ *          inlined at compile time, so stop-and-wait, Go-Back-N and
+ *          selective repeat are plain instantiations with no runtime checks.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _ENGINE_H_
+#define _ENGINE_H_
+
+#include <deque>
+#include <vector>
+
+#include "UdpSocket.h"
+#include "Timer.h"
+#include "SeqSpace.h"
+#include "Frame.h"
+
+static const long MAX_TIME = 1500;  // usec before unack'd frames are resent
+static const long MIN_TIME = 1000;  // usec an RTT-based timeout is at least
+static const int  ACKBATCH = 64;    // acks drained per system call
+
+
+// ARQ policies ---------------------------------------------------------------
+
+/**
+ * One frame in transit at a time; the receiver keeps only the next frame.
+ */
+struct StopAndWait {
+    static int window(int) { return 1; }
+    static const bool resendAll        = true;  // resend every unack'd frame
+    static const bool bufferOutOfOrder = false; // receiver keeps only in-order
+    static const bool deliverInOrder   = true;  // receiver delivers in order
+};
+
+/**
+ * Up to windowSize frames in transit; a timeout resends all of them and the
+ *  receiver discards anything that is not the next frame in order.
+ */
+struct GoBackN {
+    static int window(int windowSize) { return windowSize; }
+    static const bool resendAll        = true;
+    static const bool bufferOutOfOrder = false;
+    static const bool deliverInOrder   = true;
+};
+
+/**
+ * Up to windowSize frames in transit; a timeout resends only the oldest
+ *  unack'd frame and the receiver buffers frames that arrive early.
+ */
+struct SelectiveRepeat {
+    static int window(int windowSize) { return windowSize; }
+    static const bool resendAll        = false;
+    static const bool bufferOutOfOrder = true;
+    static const bool deliverInOrder   = true;
+};
+
+/**
+ * Selective repeat whose receiver hands each frame over as soon as it
+ *  arrives, once, so a lost frame delays only itself. Acks stay cumulative
+ *  and retransmission still guarantees every frame arrives.
+ */
+struct UnorderedRepeat {
+    static int window(int windowSize) { return windowSize; }
+    static const bool resendAll        = false;
+    static const bool bufferOutOfOrder = true;
+    static const bool deliverInOrder   = false;
+};
+
+
+// Ack strategies -------------------------------------------------------------
+
+/**
+ * The receiver acknowledges every frame as soon as it arrives.
+ */
+struct CumulativeAck {
+    static const int  EVERY = 1;    // in-order frames covered by one ack
+    static const long DELAY = 0;    // usec an ack may be held back
+    static const bool NACKS = false; // whether gaps are NACKed, not ack'd
+    static int every(int) { return EVERY; }
+};
+
+/**
+ * The receiver acknowledges every second in-order frame, holding a pending
+ *  ack back for at most DELAY usec. Out-of-order frames are ack'd at once.
+ */
+struct DelayedAck {
+    static const int  EVERY = 2;
+    static const long DELAY = 500;
+    static const bool NACKS = false;
+    static int every(int) { return EVERY; }
+};
+
+/**
+ * The receiver NACKs each gap the moment a later frame reveals it, so the
+ *  sender resends just the missing frames without waiting for a timeout,
+ *  and sends positive acks only to release the window: one per half window
+ *  of in-order frames, or DELAY usec after the first one held back. Out-
+ *  of-order frames are not ack'd at all. A path that reorders frames would
+ *  draw needless resends, which loopback and a LAN do not.
+ */
+struct NackAck {
+    static const long DELAY = 500;
+    static const bool NACKS = true;
+    static int every(int window) { return window > 2 ? window / 2 : 1; }
+};
+
+
+// Congestion controllers -----------------------------------------------------
+
+/**
+ * What the sender learned from one ack, handed to the congestion controller.
+ */
+struct AckSample {
+    int  acked;         // frames newly released by this ack
+    long rtt;           // usec round trip of the newest frame, -1 if unknown
+    int  marked;        // frames newly echoed as marked CE, 0 without ECN
+    double rate;        // bytes/sec delivered as this ack tells, 0 if unfit
+    double bandwidth;   // bytes/sec the path delivers at best, 0 if unknown
+};
+
+/**
+ * Keeps the window at the size the caller asked for, as the original
+ *  sliding window client did.
+ */
+class FixedWindow {
+ public:
+    void init(int windowSize) { cwnd = windowSize; }
+    void warm(int) { }
+    int  window() const { return cwnd; }
+    void onAck(const AckSample &) { }
+    void onTimeout() { }
+ private:
+    int cwnd;           // frames allowed in transit
+};
+
+/**
+ * A scavenger after LEDBAT: yields to every other flow by keeping the
+ *  queue it builds below TARGET usec. The base delay is the least RTT of
+ *  the last few spans of acks, and anything beyond it is taken as queuing.
+ *  Each ack moves the window by GAIN frames per window, times how far the
+ *  queuing delay is below the target, so the window grows while the path
+ *  is idle and shrinks once others fill it, by at most half per window of
+ *  acks, as RFC 6817 caps the decrease.
+ *  A timeout halves the window. It never grows past the window the caller
+ *  asked for. RTT stands in for LEDBAT's one-way delay; a queue on the ack
+ *  path makes it yield a little more than it need.
+ */
+class LedbatWindow {
+ public:
+    static const long TARGET  = 300;    // usec of queuing delay allowed
+    static const int  GAIN    = 1;      // frames per window per unit off
+    static const int  SPAN    = 256;    // rtt samples per base delay bucket
+    static const int  SPANS   = 8;      // buckets the base delay spans
+    static const int  CURRENT = 4;      // rtt samples filtered for current
+
+    void init(int windowSize) {
+        ceiling = windowSize;
+        cwnd    = windowSize < 2 ? windowSize : 2;
+        for (int i = 0; i < SPANS; ++i) {
+            spans[i] = -1;
+        } // end for (; i < SPANS; )
+        for (int i = 0; i < CURRENT; ++i) {
+            recent[i] = -1;
+        } // end for (; i < CURRENT; )
+        samples = 0;
+        queued  = 0;
+    } // end init(int)
+
+    /**
+     * Starts at a window an earlier session to the same peer reached.
+     */
+    void warm(int windowSize) {
+        cwnd = windowSize < 1 ? 1 : windowSize > ceiling ? ceiling
+                                                         : windowSize;
+    } // end warm(int)
+
+    int window() const { return cwnd < 1 ? 1 : (int)cwnd; }
+
+    void onAck(const AckSample &sample) {
+        if (sample.rtt >= 0) {
+            addSample(sample.rtt);
+        } // end if (sample.rtt >= 0)
+        if (samples == 0) {
+            return;
+        } // end if (samples == 0)
+        double off   = (double)(TARGET - queued) / TARGET;
+        double step  = GAIN * off * sample.acked / cwnd;
+        double floor = -sample.acked / 2.0;   // half a window per window
+        cwnd += step < floor ? floor : step;
+        cwnd  = cwnd < 1 ? 1 : cwnd > ceiling ? ceiling : cwnd;
+    } // end onAck(const AckSample&)
+
+    void onTimeout() { cwnd = cwnd / 2 < 1 ? 1 : cwnd / 2; }
+
+    long base() const { return baseDelay(); }
+    long queuing() const { return queued; }
+
+ private:
+    /**
+     * Files an rtt sample under the current base delay bucket and the
+     *  current delay filter, and reworks the queuing delay from both.
+     */
+    void addSample(long rtt) {
+        int span = samples / SPAN % SPANS;
+        if (samples % SPAN == 0 || rtt < spans[span]) {
+            spans[span] = rtt;          // a new bucket forgets the oldest
+        } // end if (samples % SPAN == 0...)
+        recent[samples % CURRENT] = rtt;
+        ++samples;
+        long current = rtt;
+        for (int i = 0; i < CURRENT; ++i) {
+            if (recent[i] >= 0 && recent[i] < current) {
+                current = recent[i];
+            } // end if (recent[i] >= 0...)
+        } // end for (; i < CURRENT; )
+        queued = current - baseDelay();
+    } // end addSample(long)
+
+    long baseDelay() const {
+        long least = -1;
+        for (int i = 0; i < SPANS; ++i) {
+            if (spans[i] >= 0 && (least < 0 || spans[i] < least)) {
+                least = spans[i];
+            } // end if (spans[i] >= 0...)
+        } // end for (; i < SPANS; )
+        return least;
+    } // end baseDelay()
+
+    double cwnd;            // frames allowed in transit
+    int    ceiling;         // most frames ever allowed
+    long   spans[SPANS];    // least rtt of each bucket, -1 if empty
+    long   recent[CURRENT]; // the last few rtt samples, -1 if none
+    long   samples;         // rtt samples taken
+    long   queued;          // usec of queuing delay last estimated
+};
+
+/**
+ * Reacts to ECN marks in proportion to how many there are, as DCTCP and
+ *  L4S senders do. Once per window of acked frames it folds the fraction
+ *  of them that came back marked into alpha, a moving average with gain
+ *  1 / 2^SHIFT, and if any were marked cuts the window by alpha / 2: a
+ *  queue that marks a few frames costs a little of the window and one
+ *  that marks them all halves it, as a loss would. Otherwise it grows as
+ *  Reno does, doubling per window until the first cut and by one frame per
+ *  window after. A timeout halves the window. It never grows past the
+ *  window the caller asked for.
+ */
+class DctcpWindow {
+ public:
+    static const int SHIFT = 4;         // alpha gains 1/16 of each fraction
+
+    void init(int windowSize) {
+        ceiling  = windowSize;
+        cwnd     = windowSize < 2 ? windowSize : 2;
+        ssthresh = windowSize;
+        weight   = 1;                   // the first marks halve the window
+        inRound  = 0;
+        round    = cwnd;
+        markedIn = 0;
+        cuts     = 0;
+    } // end init(int)
+
+    /**
+     * Starts at a window an earlier session to the same peer reached,
+     *  growing by one frame per window from there rather than doubling.
+     */
+    void warm(int windowSize) {
+        cwnd     = windowSize < 1 ? 1 : windowSize > ceiling ? ceiling
+                                                             : windowSize;
+        ssthresh = cwnd;
+        round    = window();
+    } // end warm(int)
+
+    int window() const { return cwnd < 1 ? 1 : (int)cwnd; }
+
+    void onAck(const AckSample &sample) {
+        inRound  += sample.acked;
+        markedIn += sample.marked;
+        if (markedIn == 0) {
+            cwnd += cwnd < ssthresh ? sample.acked
+                                    : (double)sample.acked / cwnd;
+        } // end if (markedIn == 0)
+        if (inRound >= round) {
+            double fraction = markedIn > inRound ? 1
+                                                 : (double)markedIn / inRound;
+            weight += (fraction - weight) / (1 << SHIFT);
+            if (markedIn > 0) {
+                cwnd    *= 1 - weight / 2;
+                ssthresh = cwnd;
+                ++cuts;
+            } // end if (markedIn > 0)
+            inRound  = 0;
+            markedIn = 0;
+            round    = window();
+        } // end if (inRound >= round)
+        cwnd = cwnd < 1 ? 1 : cwnd > ceiling ? ceiling : cwnd;
+    } // end onAck(const AckSample&)
+
+    void onTimeout() {
+        cwnd     = cwnd / 2 < 1 ? 1 : cwnd / 2;
+        ssthresh = cwnd;
+    } // end onTimeout()
+
+    double alpha() const { return weight; }
+    int    reductions() const { return cuts; }
+
+ private:
+    double cwnd;            // frames allowed in transit
+    double ssthresh;        // cwnd below which it doubles per window
+    int    ceiling;         // most frames ever allowed
+    double weight;          // alpha: moving fraction of frames marked
+    int    inRound;         // frames acked in this window so far
+    int    round;           // frames acked that close this window
+    int    markedIn;        // of those, frames echoed as marked
+    int    cuts;            // windows cut for marks
+};
+
+
+// Bandwidth estimation -------------------------------------------------------
+
+/**
+ * Estimates the bottleneck bandwidth of the path from the acks, as BBR
+ *  does. Every frame remembers how much had been delivered, and when, at
+ *  the moment it was sent; the ack that releases it then yields a rate
+ *  sample: the bytes delivered in between over the longer of the time
+ *  they took to send and to ack, so a burst of acks squeezed together on
+ *  the way back cannot inflate it. Samples over a shorter time than the
+ *  least RTT are dropped for the same reason. The estimate is the highest
+ *  sample of the last SPANS rounds, a round being a window of acks.
+ *  Probing, if asked for, also sends a pair of frames back to back every
+ *  PAIREVERY frames and takes the gap between their acks as the time the
+ *  bottleneck spent on the second, a packet-pair estimate of its capacity
+ *  that does not need the window to be full.
+ */
+class BandwidthEstimator {
+ public:
+    static const int SPANS     = 10;    // rounds the highest sample spans
+    static const int PAIREVERY = 256;   // frames between packet pairs
+    static const int PAIRSHIFT = 3;     // pair estimate gains 1/8 a sample
+
+    /**
+     * @param  slots  frames that may be in transit at once.
+     */
+    BandwidthEstimator(int slots)
+        : deliveredAt(slots), timeAt(slots), firstAt(slots), round(slots),
+          delivered(0), deliveredTime(0), firstSent(0), minRtt(-1),
+          samples(0), probing(false), pairing(false), pairSeq(0),
+          pairFirst(0), pairBytes(0), nextPair(0), pairRate(0) {
+        for (int i = 0; i < SPANS; ++i) {
+            spans[i] = 0;
+        } // end for (; i < SPANS; )
+    } // end BandwidthEstimator(int)
+
+    void probe(bool on) { probing = on; }
+
+    /**
+     * Notes what had been delivered as frame seq goes out of slot.
+     * @param  idle  whether nothing else is in transit.
+     * @param  room  frames the window has room for, this one included.
+     */
+    void onSend(uint32_t seq, int slot, int length, long now, bool idle,
+                int room) {
+        if (idle) {
+            firstSent = deliveredTime = now;  // rates start afresh
+        } // end if (idle)
+        deliveredAt[slot] = delivered;
+        timeAt[slot]      = deliveredTime;
+        firstAt[slot]     = firstSent;
+        if (probing && !pairing && room >= 2 &&
+            !SeqSpace::before(seq, nextPair)) {
+            pairing   = true;           // the next frame sent completes it
+            pairSeq   = seq;
+            pairFirst = 0;
+        } else if (pairing && seq == pairSeq + 1) {
+            pairBytes = length;
+        } // end if (probing...)
+    } // end onSend(uint32_t, int, int, long, bool, int)
+
+    /**
+     * Takes a rate sample from an ack that released bytes, the newest of
+     *  them the frame in slot sent at sentAt.
+     * @param  from  oldest frame the ack released.
+     * @param  to  the ack, one past the newest.
+     * @param  rtt  round trip of the newest frame, -1 if ambiguous.
+     * @return The sample in bytes/sec, or 0 if it was unfit.
+     */
+    double onAck(uint32_t from, uint32_t to, int slot, long sentAt,
+                 long bytes, long rtt, long now) {
+        delivered    += bytes;
+        deliveredTime = now;
+        firstSent     = sentAt;
+        if (rtt >= 0 && (minRtt < 0 || rtt < minRtt)) {
+            minRtt = rtt;
+        } // end if (rtt >= 0...)
+        if (pairing) {
+            onPairAck(from, to, now);
+        } // end if (pairing)
+        long sendTime = sentAt - firstAt[slot];
+        long ackTime  = now - timeAt[slot];
+        long interval = sendTime > ackTime ? sendTime : ackTime;
+        if (interval <= 0 || interval < minRtt) {
+            return 0;
+        } // end if (interval <= 0...)
+        double rate = (delivered - deliveredAt[slot]) * 1e6 / interval;
+        int    span = samples / round % SPANS;
+        if (samples % round == 0 || rate > spans[span]) {
+            spans[span] = rate;         // a new round forgets the oldest
+        } // end if (samples % round == 0...)
+        ++samples;
+        return rate;
+    } // end onAck(uint32_t, uint32_t, int, long, long, long, long)
+
+    /**
+     * @return bytes/sec: the highest delivery rate of the last SPANS
+     *          rounds, 0 before the first sample.
+     */
+    double bandwidth() const {
+        double best = 0;
+        for (int i = 0; i < SPANS; ++i) {
+            best = spans[i] > best ? spans[i] : best;
+        } // end for (; i < SPANS; )
+        return best;
+    } // end bandwidth()
+
+    double pairBandwidth() const { return pairRate; }
+    long   leastRtt() const { return minRtt; }
+
+ private:
+    /**
+     * Times the acks of the two frames of a pair. One ack releasing both
+     *  gives no gap, and the pair is tried again later.
+     */
+    void onPairAck(uint32_t from, uint32_t to, long now) {
+        bool first  = SeqSpace::before(pairSeq, to);
+        bool second = SeqSpace::before(pairSeq + 1, to);
+        if (!SeqSpace::before(pairSeq, from) && first && !second) {
+            pairFirst = now;            // the first frame alone
+            return;
+        } // end if (!SeqSpace::before(pairSeq, from)...)
+        if (!second) {
+            return;
+        } // end if (!second)
+        if (pairFirst != 0 && now > pairFirst) {
+            double sample = pairBytes * 1e6 / (now - pairFirst);
+            pairRate = pairRate == 0 ? sample
+                     : pairRate + (sample - pairRate) / (1 << PAIRSHIFT);
+        } // end if (pairFirst != 0...)
+        pairing  = false;
+        nextPair = pairSeq + PAIREVERY;
+    } // end onPairAck(uint32_t, uint32_t, long)
+
+    std::vector<long> deliveredAt;  // delivered as each frame was sent
+    std::vector<long> timeAt;       // deliveredTime then
+    std::vector<long> firstAt;      // firstSent then
+    int               round;        // rate samples to a round
+    long              delivered;    // bytes acked so far
+    long              deliveredTime; // when the last of them was acked
+    long              firstSent;    // when the newest frame acked was sent
+    long              minRtt;       // least rtt sampled, -1 if none
+    double            spans[SPANS]; // highest sample of each round
+    long              samples;      // rate samples taken
+    bool              probing;      // whether to send packet pairs
+    bool              pairing;      // whether a pair is out
+    uint32_t          pairSeq;      // its first frame
+    long              pairFirst;    // when that alone was acked, or 0
+    int               pairBytes;    // bytes of its second frame
+    uint32_t          nextPair;     // frame to start the next pair at
+    double            pairRate;     // bytes/sec the pairs measure
+};
+
+
+// Clocks ---------------------------------------------------------------------
+
+/**
+ * Wall clock time in usec from gettimeofday( ), the source Timer uses.
+ */
+struct TimerClock {
+    static long now() {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec * 1000000 + tv.tv_usec;
+    } // end now()
+};
+
+
+// Sender ---------------------------------------------------------------------
+
+template <class Arq, class Ack = CumulativeAck, class Cc = FixedWindow,
+          class Clock = TimerClock, class Transport = UdpSocket>
+class SenderEngine {
+ public:
+    /**
+     * @param  sock  bound socket with a destination set.
+     * @param  windowSize  largest number of frames that may be in transit.
+     * @pre    windowSize > 0.
+     * @post   Nothing is in transit; the first frame will carry sequence 0.
+     */
+    SenderEngine(Transport &sock, int windowSize)
+        : sock(sock), capacity(Arq::window(windowSize)), space(capacity),
+          frames(space.size() * MSGSIZE), lengths(space.size()),
+          sentAt(space.size()), expiresAt(space.size()),
+          resent(space.size()), base(0), nextSeq(0), skipTo(0),
+          timerStart(0), rto(MAX_TIME), retrans(0), dropped(0),
+          ceHeard(0), ceTaken(0), rates(space.size()), srtt(0), rttvar(0),
+          adaptive(false) {
+        cc.init(capacity);
+    } // end SenderEngine(Transport&, int)
+
+    /**
+     * @return true if another frame may be sent without overrunning the
+     *          window or the congestion controller.
+     */
+    bool canSend() const {
+        uint32_t inFlight = nextSeq - base;
+        return inFlight < (uint32_t)capacity &&
+               inFlight < (uint32_t)cc.window();
+    } // end canSend()
+
+    /**
+     * Frames msg[] behind a header, transmits it and keeps a copy for
+     *  retransmission.
+     * @param  msg  payload to transmit.
+     * @param  length  bytes of msg[]; at most PAYLOADSIZE.
+     * @param  lifetime  usec after which the frame is worthless and is
+     *                    abandoned instead of retransmitted; 0 for never.
+     * @pre    canSend() is true.
+     * @post   The frame is in transit and the retransmission timer runs.
+     * @return The sequence number given to the frame.
+     */
+    uint32_t send(const char msg[], int length, long lifetime = 0) {
+        int   slot  = space.slot(nextSeq);
+        char *frame = &frames[slot * MSGSIZE];
+        ((FrameHeader*)frame)->seq   = nextSeq;
+        ((FrameHeader*)frame)->flags = 0;
+        memcpy(frame + sizeof(FrameHeader), msg, length);
+        lengths[slot] = sizeof(FrameHeader) + length;
+        resent[slot]  = false;
+        sentAt[slot]  = Clock::now();
+        expiresAt[slot] = lifetime > 0 ? sentAt[slot] + lifetime : 0;
+        if (base == nextSeq) {
+            timerStart = sentAt[slot];      // first frame in transit
+        } // end if (base == nextSeq)
+        int room = capacity < cc.window() ? capacity : cc.window();
+        rates.onSend(nextSeq, slot, lengths[slot], sentAt[slot],
+                     base == nextSeq, room - (int)(nextSeq - base));
+        sock.sendTo(frame, lengths[slot]);
+        return nextSeq++;
+    } // end send(const char[], int)
+
+    /**
+     * Determines how far to advance the last frame ack'd by draining every
+     *  ack already queued on the socket and applying only the highest valid
+     *  one, since a later cumulative ack covers all earlier ones. If there
+     *  is none, or all are out of range, the advance is 0. The highest CE
+     *  count any EcnAckHeader echoes is kept for the next advance.
+     * @return Number of frames released from the window.
+     */
+    int ackAdvance() {
+        NackHeader heard[ACKBATCH];     // container for received acks
+        int        sizes[ACKBATCH];     // bytes of each received ack
+        AckHeader  best;                // highest valid ack seen so far
+        bool       found = false;       // whether best holds anything
+        int        received;
+        do {
+            received = sock.recvBatch((char*)heard, sizeof(NackHeader), sizes,
+                                      ACKBATCH);
+            for (int i = 0; i < received; ++i) {
+                if (sizes[i] >= (int)sizeof(NackHeader) &&
+                    (heard[i].flags & FRAME_NACK)) {
+                    onNack(heard[i]);
+                    continue;
+                } // end if (sizes[i] >= sizeof(NackHeader)...)
+                // an EcnAckHeader's count is the third word, mask here;
+                //  take it from any ack within [base, nextSeq]
+                if (sizes[i] >= (int)sizeof(EcnAckHeader) &&
+                    (heard[i].flags & FRAME_ECN) &&
+                    SeqSpace::inWindow(heard[i].seq, base,
+                                       nextSeq - base + 1) &&
+                    SeqSpace::before(ceHeard, heard[i].mask)) {
+                    ceHeard = heard[i].mask;
+                } // end if (sizes[i] >= sizeof(EcnAckHeader)...)
+                // an ack is the first two words; ensure it is whole and
+                //  within (base, nextSeq]
+                if (sizes[i] >= (int)sizeof(AckHeader) &&
+                    (heard[i].flags & FRAME_ACK) &&
+                    SeqSpace::inWindow(heard[i].seq - 1, base, nextSeq - base)
+                    && (!found || SeqSpace::before(best.ack, heard[i].seq))) {
+                    best.ack   = heard[i].seq;
+                    best.flags = heard[i].flags;
+                    found      = true;
+                } // end if (sizes[i] >= sizeof(AckHeader)...)
+            } // end for (; i < received; )
+        } while (received == ACKBATCH);
+        return found ? onAck(best) : 0;
+    } // end ackAdvance()
+
+    /**
+     * Applies a received ack to the window.
+     * @param  ack  acknowledgment from the receiver.
+     * @post   Frames below ack.ack are released and the timer restarted.
+     * @return Number of frames released from the window.
+     */
+    int onAck(const AckHeader &ack) {
+        // ensure the ack is within (base, nextSeq]
+        if (!SeqSpace::inWindow(ack.ack - 1, base, nextSeq - base)) {
+            return 0;
+        } // end if (!SeqSpace::inWindow(ack.ack - 1...))
+        AckSample sample;
+        int slot      = space.slot(ack.ack - 1);
+        long now      = Clock::now();
+        sample.acked  = ack.ack - base;
+        sample.rtt    = resent[slot] ? -1 : now - sentAt[slot];  // Karn
+        sample.marked = ceHeard - ceTaken;
+        ceTaken       = ceHeard;
+        long bytes    = 0;              // released by this ack
+        for (uint32_t i = base; i != ack.ack; ++i) {
+            bytes += lengths[space.slot(i)];
+        } // end for (; i != ack.ack; )
+        sample.rate   = rates.onAck(base, ack.ack, slot, sentAt[slot], bytes,
+                                    sample.rtt, now);
+        sample.bandwidth = rates.bandwidth();
+        if (sample.rtt >= 0) {
+            sampleRtt(sample.rtt);
+        } // end if (sample.rtt >= 0)
+        base          = ack.ack;
+        timerStart    = now;
+        if (SeqSpace::before(skipTo, base)) {
+            skipTo = base;                  // the skip has been heard
+        } // end if (SeqSpace::before(skipTo, base))
+        cc.onAck(sample);
+        return sample.acked;
+    } // end onAck(const AckHeader&)
+
+    /**
+     * Resends at once the frames a NACK names that are still in transit,
+     *  and gives them a full timeout before the timer resends anything.
+     * @return Number of frames retransmitted.
+     */
+    int onNack(const NackHeader &nack) {
+        long now   = Clock::now();
+        int  count = 0;
+        for (int i = 0; i < NACKBITS; ++i) {
+            uint32_t seq = nack.seq + i;
+            if (!(nack.mask & 1u << i) ||
+                !SeqSpace::inWindow(seq, skipTo, nextSeq - skipTo)) {
+                continue;                   // not asked for or not in transit
+            } // end if (!(nack.mask & 1u << i)...)
+            int slot = space.slot(seq);
+            if (expiresAt[slot] != 0 && now >= expiresAt[slot]) {
+                continue;                   // abandoned once it reaches head
+            } // end if (expiresAt[slot] != 0...)
+            resent[slot] = true;
+            sentAt[slot] = now;
+            sock.sendTo(&frames[slot * MSGSIZE], lengths[slot]);
+            ++count;
+        } // end for (; i < NACKBITS; )
+        if (count > 0) {
+            retrans   += count;
+            timerStart = now;
+        } // end if (count > 0)
+        return count;
+    } // end onNack(const NackHeader&)
+
+    /**
+     * Abandons frames at the head of the window whose lifetime has run out,
+     *  telling the receiver to skip past them, and resends unack'd frames
+     *  if the oldest has waited longer than the retransmission timeout, as
+     *  the ARQ policy directs. Expired frames are never resent.
+     * @return Number of frames retransmitted.
+     */
+    int checkTimeout() {
+        if (base == nextSeq) {
+            return 0;
+        } // end if (base == nextSeq)
+        long now = Clock::now();
+        if (expire(now)) {
+            sendSkip();                     // unblock the receiver at once
+            timerStart = now;
+        } // end if (expire(now))
+        if (now - timerStart <= rto) {
+            return 0;
+        } // end if (now - timerStart <= rto)
+        if (skipTo != base) {
+            sendSkip();                     // the last one may have been lost
+        } // end if (skipTo != base)
+        uint32_t last = Arq::resendAll ? nextSeq : skipTo + 1;
+        int count = 0;
+        for (uint32_t i = skipTo; i != last && i != nextSeq; ++i) {
+            int slot = space.slot(i);
+            if (expiresAt[slot] != 0 && now >= expiresAt[slot]) {
+                continue;                   // abandoned once it reaches head
+            } // end if (expiresAt[slot] != 0...)
+            resent[slot] = true;
+            sock.sendTo(&frames[slot * MSGSIZE], lengths[slot]);
+            ++count;
+        } // end for (; i != last...)
+        retrans   += count;
+        timerStart = now;
+        cc.onTimeout();
+        return count;
+    } // end checkTimeout()
+
+    /**
+     * Blocks until every frame sent has been acknowledged.
+     */
+    void flush() {
+        while (base != nextSeq) {
+            checkTimeout();
+            ackAdvance();
+        } // end while(base != nextSeq)
+    } // end flush()
+
+    /**
+     * Sends message[] max times, as the test harness does, and waits until
+     *  all of them are acknowledged or abandoned.
+     * @param  max  number of messages to be transmitted.
+     * @param  message  payload for every message.
+     * @param  lifetime  usec each message stays worth delivering; 0 for
+     *                    fully reliable delivery.
+     * @return A count of the number of frames that were transmitted more
+     *          than once.
+     */
+    int transfer(const int max, int message[], long lifetime = 0) {
+        for (int msgNum = 0; msgNum < max; ++msgNum) {
+            // wait for room in the window
+            while (!canSend()) {
+                checkTimeout();
+                ackAdvance();
+            } // end while(!canSend())
+            send((char*)message, PAYLOADSIZE, lifetime);
+            ackAdvance();
+        } // end for (; msgNum < max; )
+        flush();
+        return retrans;
+    } // end transfer(const int, int[])
+
+    bool     idle() const { return base == nextSeq; }
+    int      retransmits() const { return retrans; }
+    int      abandoned() const { return dropped; }
+    uint32_t nextSequence() const { return nextSeq; }
+    Cc      &controller() { return cc; }
+    BandwidthEstimator &estimator() { return rates; }
+    long     smoothedRtt() const { return srtt; }
+    long     rttVariance() const { return rttvar; }
+    long     timeout() const { return rto; }
+
+    /**
+     * Lets the timeout follow the RTT, as SRTT plus four deviations within
+     *  [MIN_TIME, MAX_TIME], rather than stay at the fixed MAX_TIME the
+     *  assignment's tests expect.
+     */
+    void followRtt() {
+        adaptive = true;
+        if (srtt > 0) {
+            adaptRto();
+        } // end if (srtt > 0)
+    } // end followRtt()
+
+    /**
+     * Starts from what an earlier session to the same peer learned rather
+     *  than from nothing, with the timeout following the RTT from there,
+     *  so a seed that no longer fits the path is corrected by this
+     *  session's own samples.
+     * @param  windowSize  frames the controller starts with in transit.
+     * @param  smoothed  that session's smoothed RTT, and variance, which
+     *                    seed this one's; 0 to sample afresh.
+     * @pre    Nothing has been sent.
+     */
+    void warm(int windowSize, long smoothed, long variance) {
+        cc.warm(windowSize);
+        srtt   = smoothed;
+        rttvar = variance;
+        followRtt();
+    } // end warm(int, long, long)
+
+ private:
+    Transport        &sock;         // carries frames out and acks in
+    Cc                cc;           // congestion controller
+    int               capacity;     // largest window the ARQ policy allows
+    SeqSpace          space;        // maps sequence numbers to slots
+    std::vector<char> frames;       // copies of frames in transit
+    std::vector<int>  lengths;      // bytes of each buffered frame
+    std::vector<long> sentAt;       // time each frame was last sent
+    std::vector<long> expiresAt;    // time each frame expires, 0 for never
+    std::vector<bool> resent;       // whether each frame was retransmitted
+    uint32_t          base;         // oldest unack'd sequence number
+    uint32_t          nextSeq;      // sequence number of the next new frame
+    uint32_t          skipTo;       // frames below it have been abandoned
+    long              timerStart;   // time of the last progress or resend
+    long              rto;          // retransmission timeout in usec
+    int               retrans;      // frames transmitted more than once
+    int               dropped;      // frames abandoned after expiring
+    uint32_t          ceHeard;      // frames the receiver has seen marked CE
+    uint32_t          ceTaken;      // of those, ones passed to the controller
+    BandwidthEstimator rates;       // delivery rate and packet-pair samples
+    long              srtt;         // smoothed RTT in usec, 0 until sampled
+    long              rttvar;       // mean deviation of the RTT in usec
+    bool              adaptive;     // whether rto follows srtt and rttvar
+
+    /**
+     * Folds an RTT sample into srtt and rttvar as RFC 6298 does, and the
+     *  timeout with them once the engine has been warmed.
+     */
+    void sampleRtt(long rtt) {
+        if (srtt == 0) {
+            srtt   = rtt;
+            rttvar = rtt / 2;
+        } else {
+            long delta = rtt > srtt ? rtt - srtt : srtt - rtt;
+            rttvar = (3 * rttvar + delta) / 4;
+            srtt   = (7 * srtt + rtt) / 8;
+        } // end if (srtt == 0)
+        if (adaptive) {
+            adaptRto();
+        } // end if (adaptive)
+    } // end sampleRtt(long)
+
+    /**
+     * Sets the timeout to SRTT plus four deviations, within [MIN_TIME,
+     *  MAX_TIME].
+     */
+    void adaptRto() {
+        rto = srtt + 4 * rttvar;
+        rto = rto < MIN_TIME ? MIN_TIME : rto > MAX_TIME ? MAX_TIME : rto;
+    } // end adaptRto()
+
+    /**
+     * Moves skipTo past every expired frame at the head of the window.
+     * @return true if any frame was abandoned.
+     */
+    bool expire(long now) {
+        uint32_t from = skipTo;
+        while (skipTo != nextSeq) {
+            long expires = expiresAt[space.slot(skipTo)];
+            if (expires == 0 || now < expires) {
+                break;
+            } // end if (expires == 0...)
+            ++skipTo;
+        } // end while(skipTo != nextSeq)
+        dropped += skipTo - from;
+        return skipTo != from;
+    } // end expire(long)
+
+    /**
+     * Tells the receiver that every frame below skipTo is abandoned.
+     */
+    void sendSkip() {
+        FrameHeader skip;
+        skip.seq   = skipTo;
+        skip.flags = FRAME_SKIP;
+        sock.sendTo((char*)&skip, sizeof(skip));
+    } // end sendSkip()
+};
+
+
+// Receiver -------------------------------------------------------------------
+
+template <class Arq, class Ack = CumulativeAck, class Clock = TimerClock,
+          class Transport = UdpSocket>
+class ReceiverEngine {
+ public:
+    /**
+     * @param  sock  bound socket frames arrive on.
+     * @param  windowSize  largest number of frames the sender has in transit.
+     * @pre    windowSize > 0.
+     * @post   The first frame expected carries sequence 0.
+     */
+    ReceiverEngine(Transport &sock, int windowSize)
+        : sock(sock), capacity(Arq::window(windowSize)), space(capacity),
+          frames(space.size() * MSGSIZE), lengths(space.size(), +EMPTY),
+          nextExpected(0), nextDeliver(0), nextUnseen(0),
+          ackEvery(Ack::every(capacity)), pending(0), pendingSince(0),
+          lost(0), acked(0), nacked(0), ceMarked(0) { }
+
+    /**
+     * Blocks until a frame arrives, then buffers and acknowledges it. A
+     *  delayed ack that comes due while waiting is sent on the way; the
+     *  wait for it sleeps in the transport's pollRecvFrom(usec) rather than
+     *  spinning, so a sender on the same CPU keeps running.
+     * @return Number of frames that became deliverable in order.
+     */
+    int receive() {
+        char frame[MSGSIZE];
+        int  length = recvFrame(frame);
+        return onFrame(frame, length);
+    } // end receive()
+
+    /**
+     * As receive(), but only reads the frame into frame[], for a layer
+     *  above that screens frames before passing them to onFrame().
+     * @param  frame  container of at least MSGSIZE bytes.
+     * @return Bytes of frame[].
+     */
+    int recvFrame(char frame[]) {
+        while (Ack::DELAY > 0 && pending > 0 &&
+               sock.pollRecvFrom(pendingSince + Ack::DELAY + 1 -
+                                 Clock::now()) < 1) {
+            checkAck();
+        } // end while(Ack::DELAY > 0...)
+        return sock.recvFrom(frame, MSGSIZE);
+    } // end recvFrame(char[])
+
+    /**
+     * Buffers a frame if it falls in the receive window and acknowledges it
+     *  as the ack strategy directs.
+     * @param  frame  datagram as received.
+     * @param  length  bytes of frame[].
+     * @return Number of frames that became deliverable in order.
+     */
+    int onFrame(const char frame[], int length) {
+        if (length < (int)sizeof(FrameHeader) ||
+            (((const FrameHeader*)frame)->flags & FRAME_ACK)) {
+            return 0;                       // runt or stray ack
+        } // end if (length < sizeof(FrameHeader)...)
+        if (((const FrameHeader*)frame)->flags & FRAME_CE) {
+            ++ceMarked;                     // echoed in every ack from now
+        } // end if (flags & FRAME_CE)
+        if (((const FrameHeader*)frame)->flags & FRAME_SKIP) {
+            return onSkip(((const FrameHeader*)frame)->seq);
+        } // end if (flags & FRAME_SKIP)
+        uint32_t seq  = ((const FrameHeader*)frame)->seq;
+        uint32_t edge = Arq::bufferOutOfOrder ? capacity : 1;
+        int      slot = space.slot(seq);
+        // ensure sequence number is within expected range
+        if (SeqSpace::inWindow(seq, nextExpected, edge) &&
+            SeqSpace::inWindow(seq, nextDeliver, capacity) &&
+            lengths[slot] == EMPTY) {
+            memcpy(&frames[slot * MSGSIZE], frame, length);
+            lengths[slot] = length;
+            if (!Arq::deliverInOrder) {
+                arrivals.push_back(seq);    // deliverable right away
+            } // end if (!Arq::deliverInOrder)
+            if (Ack::NACKS && SeqSpace::before(nextUnseen, seq)) {
+                sendNack(SeqSpace::before(nextUnseen, nextExpected)
+                             ? nextExpected : nextUnseen, seq);
+            } // end if (Ack::NACKS...)
+            if (!SeqSpace::before(seq, nextUnseen)) {
+                nextUnseen = seq + 1;
+            } // end if (!SeqSpace::before(seq, nextUnseen))
+        } // end if (SeqSpace::inWindow(seq...))
+        uint32_t before  = nextExpected;
+        int      advance = advanceExpected();
+        if (Ack::NACKS && SeqSpace::before(before, seq)) {
+            return advance;                 // out of order; NACKed above
+        } // end if (Ack::NACKS...)
+        if (advance == 0 || seq != before) {
+            sendAck();                      // duplicate or out of order
+        } else if ((pending += advance) >= ackEvery) {
+            sendAck();
+        } else if (pending == advance) {
+            pendingSince = Clock::now();    // first frame held back
+        } // end if (advance == 0...)
+        return advance;
+    } // end onFrame(const char[], int)
+
+    /**
+     * Gives up on every missing frame below skipTo, as the sender asked, and
+     *  acknowledges the new position at once.
+     * @param  skipTo  first sequence number the sender has not abandoned.
+     * @return Number of frames that became deliverable in order, counting
+     *          the abandoned ones, which deliver() passes over.
+     */
+    int onSkip(uint32_t skipTo) {
+        uint32_t before = nextExpected;
+        if (SeqSpace::before(nextDeliver + capacity, skipTo)) {
+            skipTo = nextDeliver + capacity;    // the rest on a later skip
+        } // end if (SeqSpace::before(nextDeliver + capacity, skipTo))
+        for (; SeqSpace::before(nextExpected, skipTo); ++nextExpected) {
+            int slot = space.slot(nextExpected);
+            if (lengths[slot] == EMPTY) {
+                lengths[slot] = SKIPPED;
+            } // end if (lengths[slot] == EMPTY)
+        } // end for (; SeqSpace::before(nextExpected, skipTo); )
+        advanceExpected();
+        release();
+        sendAck();
+        return nextExpected - before;
+    } // end onSkip(uint32_t)
+
+    /**
+     * Sends a held-back ack once it has waited DELAY usec.
+     */
+    void checkAck() {
+        if (pending > 0 && Clock::now() - pendingSince > Ack::DELAY) {
+            sendAck();
+        } // end if (pending > 0...)
+    } // end checkAck()
+
+    /**
+     * Copies the payload of the next frame into msg[]: the next in order,
+     *  or with an unordered policy the oldest arrival not yet delivered.
+     * @param  msg  container of at least PAYLOADSIZE bytes.
+     * @return Bytes of payload, or -1 if no frame is ready.
+     */
+    int deliver(char msg[]) {
+        int slot;
+        if (Arq::deliverInOrder) {
+            release();                      // pass over abandoned frames
+            if (nextDeliver == nextExpected) {
+                return -1;
+            } // end if (nextDeliver == nextExpected)
+            slot = space.slot(nextDeliver++);
+        } else {
+            if (arrivals.empty()) {
+                return -1;
+            } // end if (arrivals.empty())
+            slot = space.slot(arrivals.front());
+            arrivals.pop_front();
+        } // end if (Arq::deliverInOrder)
+        int length = lengths[slot] - sizeof(FrameHeader);
+        memcpy(msg, &frames[slot * MSGSIZE] + sizeof(FrameHeader), length);
+        if (Arq::deliverInOrder) {
+            lengths[slot] = EMPTY;
+        } else {
+            lengths[slot] = DELIVERED;      // hold the slot for dedup
+            release();
+        } // end if (Arq::deliverInOrder)
+        return length;
+    } // end deliver(char[])
+
+    /**
+     * Receives and acknowledges frames until max messages have been
+     *  delivered, as the test harness does.
+     * @param  max  number of messages to be received.
+     * @param  message  container for each delivered payload.
+     */
+    void transfer(const int max, int message[]) {
+        while (SeqSpace::before(nextDeliver, max)) {
+            receive();
+            while (deliver((char*)message) >= 0) { }
+        } // end while(SeqSpace::before(nextDeliver, max))
+        if (pending > 0) {
+            sendAck();
+        } // end if (pending > 0)
+    } // end transfer(const int, int[])
+
+    /**
+     * Answers the sender's retransmissions once every message has been
+     *  delivered, so a final ack that was lost is sent again rather than
+     *  leaving the sender to flush forever. Returns once quiet usec pass
+     *  with nothing arriving, or on a frame that is not a retransmission,
+     *  as the first of a next pass on the same port is; that frame is
+     *  dropped and its sender resends it to the next engine.
+     * @param  quiet  usec of silence that shows the sender has stopped.
+     */
+    void linger(long quiet) {
+        char frame[MSGSIZE];
+        while (sock.pollRecvFrom(quiet) > 0) {
+            int length = sock.recvFrom(frame, MSGSIZE);
+            if (length >= (int)sizeof(FrameHeader) &&
+                !(((const FrameHeader*)frame)->flags & FRAME_ACK) &&
+                !SeqSpace::inWindow(((const FrameHeader*)frame)->seq,
+                                    nextExpected - capacity, capacity)) {
+                return;                     // the sender has moved on
+            } // end if (length >= sizeof(FrameHeader)...)
+            onFrame(frame, length);
+        } // end while(sock.pollRecvFrom(quiet) > 0)
+    } // end linger(long)
+
+    bool     ready() const {
+        return Arq::deliverInOrder ? nextDeliver != nextExpected
+                                   : !arrivals.empty();
+    } // end ready()
+    uint32_t expected() const { return nextExpected; }
+    int      skipped() const { return lost; }
+    int      acks() const { return acked; }
+    int      nacks() const { return nacked; }
+    int      marked() const { return ceMarked; }
+
+    /**
+     * @return true if frame seq has arrived or been skipped, false if it is
+     *          still missing or beyond the window.
+     */
+    bool holds(uint32_t seq) const {
+        if (SeqSpace::before(seq, nextExpected)) {
+            return true;
+        } // end if (SeqSpace::before(seq, nextExpected))
+        return SeqSpace::inWindow(seq, nextDeliver, capacity) &&
+               lengths[space.slot(seq)] != EMPTY;
+    } // end holds(uint32_t)
+
+ private:
+    static const int EMPTY     = -1;    // length of a slot with no frame
+    static const int SKIPPED   = -2;    // slot of a frame the sender abandoned
+    static const int DELIVERED = -3;    // slot of a frame delivered early
+
+    /**
+     * Frees the slots below nextExpected that hold nothing left to deliver:
+     *  abandoned frames and, with an unordered policy, delivered ones.
+     */
+    void release() {
+        while (nextDeliver != nextExpected) {
+            int slot = space.slot(nextDeliver);
+            if (lengths[slot] == SKIPPED) {
+                ++lost;
+            } else if (lengths[slot] != DELIVERED) {
+                break;                      // still to be delivered
+            } // end if (lengths[slot] == SKIPPED)
+            lengths[slot] = EMPTY;
+            ++nextDeliver;
+        } // end while(nextDeliver != nextExpected)
+    } // end release()
+
+    /**
+     * Moves nextExpected past every frame already buffered.
+     * @return How far it moved.
+     */
+    int advanceExpected() {
+        uint32_t before = nextExpected;
+        while (SeqSpace::before(nextExpected, nextDeliver + capacity) &&
+               lengths[space.slot(nextExpected)] != EMPTY) {
+            ++nextExpected;
+        } // end while(SeqSpace::before(nextExpected...))
+        return nextExpected - before;
+    } // end advanceExpected()
+
+    /**
+     * Sends a cumulative ack naming the next sequence number expected,
+     *  echoing the count of frames marked CE once there has been one.
+     */
+    void sendAck() {
+        EcnAckHeader ack;
+        ack.ack   = nextExpected;
+        ack.flags = FRAME_ACK;
+        ack.ce    = ceMarked;
+        if (ceMarked > 0) {
+            ack.flags |= FRAME_ECN;
+            sock.ackTo((char*)&ack, sizeof(EcnAckHeader));
+        } else {
+            sock.ackTo((char*)&ack, sizeof(AckHeader));
+        } // end if (ceMarked > 0)
+        pending = 0;
+        ++acked;
+    } // end sendAck()
+
+    /**
+     * Sends NACKs naming every frame in [from, to), which a frame at to has
+     *  just revealed missing.
+     */
+    void sendNack(uint32_t from, uint32_t to) {
+        NackHeader nack;
+        nack.flags = FRAME_NACK;
+        nack.from  = 0;
+        for (nack.seq = from; SeqSpace::before(nack.seq, to);
+             nack.seq += NACKBITS) {
+            uint32_t gap = to - nack.seq;
+            nack.mask = gap >= NACKBITS ? 0xFFFFFFFF : (1u << gap) - 1;
+            sock.ackTo((char*)&nack, sizeof(nack));
+            ++nacked;
+        } // end for (nack.seq = from...)
+    } // end sendNack(uint32_t, uint32_t)
+
+    Transport        &sock;         // carries frames in and acks out
+    int               capacity;     // receive window in frames
+    SeqSpace          space;        // maps sequence numbers to slots
+    std::vector<char> frames;       // frames received but not delivered
+    std::vector<int>  lengths;      // bytes of each frame, or a slot state
+    std::deque<uint32_t> arrivals;  // unordered frames not yet delivered
+    uint32_t          nextExpected; // lowest sequence number not received
+    uint32_t          nextDeliver;  // next sequence number to hand over
+    uint32_t          nextUnseen;   // one past the highest frame received
+    int               ackEvery;     // in-order frames covered by one ack
+    int               pending;      // in-order frames not yet ack'd
+    long              pendingSince; // time the oldest of those arrived
+    int               lost;         // abandoned frames passed over
+    int               acked;        // acks sent
+    int               nacked;       // NACKs sent
+    uint32_t          ceMarked;     // frames received marked CE
+};
+
+#endif
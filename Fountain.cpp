@@ -0,0 +1,224 @@
+/*
+ * @file   Fountain.cpp
+ * @brief  Implements the LT encoder and peeling decoder declared in
+ *          Fountain.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "Fountain.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+static const int    WORDS   = SYMBOLSIZE / 8; // 64-bit words of a symbol
+static const double LTC     = 0.03;     // robust soliton c: ripple size
+static const double LTDELTA = 0.5;      // and delta: bound on decode failure
+
+/**
+ * Steps a splitmix64 generator, which any seed starts well.
+ */
+static inline uint64_t splitmix(uint64_t &state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+} // end splitmix(uint64_t&)
+
+static inline void xorInto(uint64_t to[], const uint64_t from[]) {
+    for (int w = 0; w < WORDS; ++w) {
+        to[w] ^= from[w];
+    } // end for (; w < WORDS; )
+} // end xorInto(uint64_t[], const uint64_t[])
+
+/**
+ * @return Source symbols an object of length bytes is cut into.
+ */
+static int symbolsOf(int length) {
+    return length > SYMBOLSIZE ? (length + SYMBOLSIZE - 1) / SYMBOLSIZE : 1;
+} // end symbolsOf(int)
+
+
+/**
+ * Tabulates the robust soliton distribution over degrees 1 to symbols: the
+ *  ideal soliton, plus extra weight on low degrees and a spike at K / R so
+ *  that about R symbols of degree one stay ready while peeling.
+ */
+LtCode::LtCode(int symbols)
+    : k(symbols), cdf(symbols), stamp(symbols, 0), draws(0) {
+    double r     = LTC * log(k / LTDELTA) * sqrt((double)k);
+    int    spike = r > 0 ? (int)(k / r) : k;
+    spike = std::max(1, std::min(k, spike));
+    std::vector<double> mu(k + 1, 0);
+    double total = 0;
+    for (int d = 1; d <= k; ++d) {
+        mu[d] = d == 1 ? 1.0 / k : 1.0 / (d * (d - 1.0));  // ideal soliton
+        if (d < spike) {
+            mu[d] += r / (d * (double)k);
+        } else if (d == spike && r > LTDELTA) {
+            mu[d] += r * log(r / LTDELTA) / k;
+        } // end if (d < spike)
+        total += mu[d];
+    } // end for (; d <= k; )
+    double sum = 0;
+    for (int d = 1; d <= k; ++d) {
+        sum       += mu[d];
+        cdf[d - 1] = (uint32_t)std::min(sum / total * 4294967296.0,
+                                        4294967295.0);
+    } // end for (; d <= k; )
+    cdf[k - 1] = 0xFFFFFFFF;
+} // end LtCode(int)
+
+
+/**
+ * Draws the distinct source symbols XORed into symbol id.
+ * @param  out  set to the neighbors.
+ * @return The degree of the symbol.
+ */
+int LtCode::neighbors(uint32_t id, std::vector<uint32_t> &out) {
+    uint64_t state  = (uint64_t)id << 32 | (uint32_t)k;
+    uint32_t draw   = splitmix(state) >> 32;
+    int      degree = std::upper_bound(cdf.begin(), cdf.end() - 1, draw)
+                      - cdf.begin() + 1;
+    if (++draws == 0) {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        draws = 1;
+    } // end if (++draws == 0)
+    out.clear();
+    while ((int)out.size() < degree) {
+        uint32_t s = (splitmix(state) >> 32) * (uint64_t)k >> 32;
+        if (stamp[s] != draws) {
+            stamp[s] = draws;
+            out.push_back(s);
+        } // end if (stamp[s] != draws)
+    } // end while(out.size() < degree)
+    return degree;
+} // end neighbors(uint32_t, std::vector<uint32_t>&)
+
+
+/**
+ * @param  object  bytes to encode, copied so the caller may reuse them.
+ */
+LtEncoder::LtEncoder(const char object[], int length)
+    : code(symbolsOf(length)), bytes(length),
+      source(code.symbols() * WORDS, 0) {
+    memcpy(&source[0], object, length);
+} // end LtEncoder(const char[], int)
+
+
+/**
+ * Writes symbol id, SYMBOLSIZE bytes, to out[].
+ */
+void LtEncoder::encode(uint32_t id, char out[]) {
+    uint64_t sum[WORDS];
+    int      degree = code.neighbors(id, picked);
+    memcpy(sum, &source[picked[0] * WORDS], SYMBOLSIZE);
+    for (int i = 1; i < degree; ++i) {
+        xorInto(sum, &source[picked[i] * WORDS]);
+    } // end for (; i < degree; )
+    memcpy(out, sum, SYMBOLSIZE);
+} // end encode(uint32_t, char[])
+
+
+/**
+ * @param  symbols  source symbols of the object, from its FountainHeader.
+ * @param  length  bytes of the object, likewise.
+ */
+LtDecoder::LtDecoder(int symbols, int length)
+    : code(symbols), bytes(length), source(symbols * WORDS),
+      known(symbols, false), solved(0), heard(0), waiting(symbols) {
+    pending.reserve((size_t)symbols * WORDS);   // most stay pending a while
+} // end LtDecoder(int, int)
+
+
+/**
+ * Adds symbol id, SYMBOLSIZE bytes at in[], to what is known. A symbol
+ *  that covers two or more unknown source symbols is kept as it came and
+ *  only counts them down as they are recovered; the source symbols are
+ *  XORed out of it once, when one unknown is left, and never out of the
+ *  many that end up covering nothing new.
+ * @return true once the whole object is decoded.
+ */
+bool LtDecoder::add(uint32_t id, const char in[]) {
+    if (done()) {
+        return true;
+    } // end if (done())
+    ++heard;
+    int degree = code.neighbors(id, picked);
+    int left   = 0;
+    for (int i = 0; i < degree; ++i) {
+        left += !known[picked[i]];
+    } // end for (; i < degree; )
+    if (left == 0) {
+        return false;                       // nothing new
+    } // end if (left == 0)
+    uint32_t p = unknowns.size();
+    unknowns.push_back(left);
+    edgeFrom.push_back(edges.size());
+    edges.insert(edges.end(), picked.begin(), picked.end());
+    pending.insert(pending.end(), (const uint64_t*)in,
+                   (const uint64_t*)in + WORDS);
+    if (left == 1) {
+        resolve(p);
+        peel();
+        return done();
+    } // end if (left == 1)
+    for (int i = 0; i < degree; ++i) {
+        if (!known[picked[i]]) {
+            waiting[picked[i]].push_back(p);
+        } // end if (!known[picked[i]])
+    } // end for (; i < degree; )
+    return false;
+} // end add(uint32_t, const char[])
+
+
+/**
+ * Recovers the one unknown neighbor of pending symbol p, if it has one,
+ *  by XORing every other neighbor out of it. Its other neighbors are all
+ *  known, even those still waiting in the ripple.
+ */
+void LtDecoder::resolve(uint32_t p) {
+    uint64_t *sum   = &pending[(size_t)p * WORDS];
+    uint32_t  end   = p + 1 < edgeFrom.size() ? edgeFrom[p + 1]
+                                              : edges.size();
+    int64_t   found = -1;
+    unknowns[p] = 0;
+    for (uint32_t e = edgeFrom[p]; e < end; ++e) {
+        if (known[edges[e]]) {
+            xorInto(sum, &source[(size_t)edges[e] * WORDS]);
+        } else {
+            found = edges[e];
+        } // end if (known[edges[e]])
+    } // end for (; e < end; )
+    if (found >= 0) {
+        recover(found, sum);
+    } // end if (found >= 0)
+} // end resolve(uint32_t)
+
+
+void LtDecoder::recover(uint32_t s, const uint64_t data[]) {
+    memcpy(&source[(size_t)s * WORDS], data, SYMBOLSIZE);
+    known[s] = true;
+    ++solved;
+    ripple.push_back(s);
+} // end recover(uint32_t, const uint64_t[])
+
+
+/**
+ * Counts each newly known source symbol off the pending symbols waiting on
+ *  it and resolves those left with one.
+ */
+void LtDecoder::peel() {
+    while (!ripple.empty()) {
+        uint32_t s = ripple.back();
+        ripple.pop_back();
+        for (size_t i = 0; i < waiting[s].size(); ++i) {
+            uint32_t p = waiting[s][i];
+            if (unknowns[p] != 0 && --unknowns[p] == 1) {
+                resolve(p);
+            } // end if (unknowns[p] != 0...)
+        } // end for (; i < waiting[s].size(); )
+        std::vector<uint32_t>().swap(waiting[s]);
+    } // end while(!ripple.empty())
+} // end peel()
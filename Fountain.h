@@ -0,0 +1,263 @@
+/*
+ * @file   Fountain.h
+ * @brief  Declares one-to-many distribution of an object with an LT
+ *          fountain code. The object is cut into K source symbols and the
+ *          sender streams encoded symbols without end: each is the XOR of
+ *          a few source symbols, how many drawn from the robust soliton
+ *          distribution and which drawn at random, both seeded by the
+ *          symbol's id so a receiver can work them out for itself. Any
+ *          K(1 + e) symbols decode the object by peeling, whichever they
+ *          are, so a receiver needs no repairs and says nothing until it
+ *          is done; then it multicasts a FRAME_DONE, and the sender stops
+ *          once every receiver it expects has. Symbols are whole 64-bit
+ *          words and every XOR runs a word at a time, which keeps encoding
+ *          and decoding to a few microseconds per symbol.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _FOUNTAIN_H_
+#define _FOUNTAIN_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "Engine.h"
+#include "McastSocket.h"
+
+// bytes of a symbol: whole 64-bit words that fit behind a FountainHeader
+#define SYMBOLSIZE ( ( MSGSIZE - (int)sizeof( FountainHeader ) ) / 8 * 8 )
+
+static const long DONEWAIT = 1000;  // usec between a receiver's FRAME_DONEs
+
+/**
+ * Works out the degree and neighbors of every symbol id for an object of
+ *  a given number of source symbols, the same way at both ends.
+ */
+class LtCode {
+ public:
+    LtCode(int symbols);
+    int symbols() const { return k; }
+    int neighbors(uint32_t id, std::vector<uint32_t> &out);
+
+ private:
+    int                   k;        // source symbols
+    std::vector<uint32_t> cdf;      // degree d + 1 is drawn below cdf[d]
+    std::vector<uint32_t> stamp;    // last draw that picked each symbol
+    uint32_t              draws;    // calls to neighbors() so far
+};
+
+
+class LtEncoder {
+ public:
+    LtEncoder(const char object[], int length);
+    int  symbols() const { return code.symbols(); }
+    int  length() const { return bytes; }
+    void encode(uint32_t id, char out[]);
+
+ private:
+    LtCode                code;     // degree and neighbors of each id
+    int                   bytes;    // bytes of the object
+    std::vector<uint64_t> source;   // the object, padded to whole symbols
+    std::vector<uint32_t> picked;   // neighbors of the symbol being encoded
+};
+
+
+class LtDecoder {
+ public:
+    LtDecoder(int symbols, int length);
+    bool add(uint32_t id, const char in[]);
+    bool done() const { return solved == code.symbols(); }
+    int  symbols() const { return code.symbols(); }
+    int  length() const { return bytes; }
+    int  received() const { return heard; }
+    const char *object() const { return (const char*)&source[0]; }
+
+ private:
+    void resolve(uint32_t p);
+    void recover(uint32_t s, const uint64_t data[]);
+    void peel();
+
+    LtCode                code;     // degree and neighbors of each id
+    int                   bytes;    // bytes of the object
+    std::vector<uint64_t> source;   // source symbols, valid where known
+    std::vector<bool>     known;    // whether each source symbol is
+    int                   solved;   // source symbols known
+    int                   heard;    // encoded symbols added
+    std::vector<uint64_t> pending;  // symbols kept as they came
+    std::vector<int>      unknowns; // neighbors of each not yet peeled
+    std::vector<uint32_t> edgeFrom; // where each one's neighbors start
+    std::vector<uint32_t> edges;    // those neighbors
+    std::vector<std::vector<uint32_t> >
+                          waiting;  // pending symbols on each source symbol
+    std::vector<uint32_t> ripple;   // source symbols known, not yet peeled
+    std::vector<uint32_t> picked;   // neighbors of the symbol being added
+};
+
+
+/**
+ * Streams the symbols of an object to a group until enough receivers have
+ *  decoded it.
+ */
+template <class Clock = TimerClock, class Transport = McastSocket>
+class FountainSender {
+ public:
+    /**
+     * @param  sock  transport joined to the group.
+     * @param  object  bytes to distribute.
+     * @param  interval  usec between symbols.
+     */
+    FountainSender(Transport &sock, const char object[], int length,
+                   long interval)
+        : sock(sock), encoder(object, length), interval(interval),
+          nextId(0), coding(0) { }
+
+    /**
+     * Sends symbols until receivers distinct receivers have reported done
+     *  or limit symbols have gone out.
+     * @return Symbols sent.
+     */
+    int run(int receivers, int limit) {
+        char frame[MSGSIZE];
+        FountainHeader *header = (FountainHeader*)frame;
+        header->flags   = FRAME_CODED;
+        header->symbols = encoder.symbols();
+        header->length  = encoder.length();
+        long lastSend   = 0;
+        while ((int)finished.size() < receivers && (int)nextId < limit) {
+            poll();
+            if (Clock::now() - lastSend < interval) {
+                continue;
+            } // end if (Clock::now() - lastSend < interval)
+            long start = Clock::now();
+            header->seq = nextId++;
+            encoder.encode(header->seq, frame + sizeof(FountainHeader));
+            coding += Clock::now() - start;
+            sock.sendTo(frame, sizeof(FountainHeader) + SYMBOLSIZE);
+            lastSend = start;
+        } // end while(finished.size() < receivers...)
+        return nextId;
+    } // end run(int, int)
+
+    int  sent() const { return nextId; }
+    int  completions() const { return finished.size(); }
+    long encodeTime() const { return coding; }
+
+ private:
+    /**
+     * Takes in every FRAME_DONE waiting, counting each receiver once.
+     */
+    void poll() {
+        static thread_local FrameHeader heard[ACKBATCH];
+        int sizes[ACKBATCH];
+        int received = sock.recvBatch((char*)heard, sizeof(FrameHeader),
+                                      sizes, ACKBATCH);
+        for (int i = 0; i < received; ++i) {
+            if (sizes[i] < (int)sizeof(FrameHeader) ||
+                !(heard[i].flags & FRAME_DONE)) {
+                continue;                   // our own symbols looping back
+            } // end if (sizes[i] < sizeof(FrameHeader)...)
+            bool known = false;
+            for (size_t r = 0; r < finished.size(); ++r) {
+                known |= finished[r] == heard[i].seq;
+            } // end for (; r < finished.size(); )
+            if (!known) {
+                finished.push_back(heard[i].seq);
+            } // end if (!known)
+        } // end for (; i < received; )
+    } // end poll()
+
+    Transport            &sock;     // joined to the group
+    LtEncoder             encoder;  // makes each symbol
+    long                  interval; // usec between symbols
+    uint32_t              nextId;   // id of the next symbol
+    long                  coding;   // usec spent encoding
+    std::vector<uint32_t> finished; // tags of the receivers that are done
+};
+
+
+template <class Clock = TimerClock, class Transport = McastSocket>
+class FountainReceiver {
+ public:
+    /**
+     * @param  sock  transport joined to the group.
+     * @param  tag  names this receiver in its FRAME_DONEs.
+     */
+    FountainReceiver(Transport &sock, uint32_t tag)
+        : sock(sock), decoder(NULL), tag(tag), lastDone(0), decoding(0) { }
+    ~FountainReceiver() { delete decoder; }
+
+    /**
+     * Blocks until the object is decoded and reports it done.
+     * @return The decoded object; length() bytes long.
+     */
+    const char *transfer() {
+        static thread_local char msgs[ACKBATCH * MSGSIZE];
+        int sizes[ACKBATCH];
+        while (!done()) {
+            sizes[0] = sock.recvFrom(msgs, MSGSIZE);
+            onSymbol(msgs, sizes[0]);
+            int received = sock.recvBatch(msgs, MSGSIZE, sizes, ACKBATCH);
+            for (int i = 0; i < received; ++i) {
+                onSymbol(msgs + i * MSGSIZE, sizes[i]);
+            } // end for (; i < received; )
+        } // end while(!done())
+        reportDone();
+        return decoder->object();
+    } // end transfer()
+
+    /**
+     * Repeats FRAME_DONE while symbols keep coming, in case the sender
+     *  missed it, and returns once none have come for quiet usec.
+     */
+    void linger(long quiet) {
+        char msg[MSGSIZE];
+        while (sock.pollRecvFrom(quiet) > 0) {
+            if (sock.recvFrom(msg, MSGSIZE) >= (int)sizeof(FrameHeader) &&
+                (((FrameHeader*)msg)->flags & FRAME_CODED) &&
+                Clock::now() - lastDone >= DONEWAIT) {
+                reportDone();
+            } // end if (sock.recvFrom(msg, MSGSIZE)...)
+        } // end while(sock.pollRecvFrom(quiet) > 0)
+    } // end linger(long)
+
+    bool done() const { return decoder != NULL && decoder->done(); }
+    int  length() const { return decoder->length(); }
+    int  symbols() const { return decoder->symbols(); }
+    int  received() const { return decoder->received(); }
+    long decodeTime() const { return decoding; }
+
+ private:
+    /**
+     * Adds one encoded symbol, starting the decoder on the first.
+     */
+    void onSymbol(const char msg[], int size) {
+        const FountainHeader *header = (const FountainHeader*)msg;
+        if (size < (int)sizeof(FountainHeader) + SYMBOLSIZE ||
+            !(header->flags & FRAME_CODED) || done()) {
+            return;                         // a FRAME_DONE or a runt
+        } // end if (size < sizeof(FountainHeader) + SYMBOLSIZE...)
+        if (decoder == NULL) {
+            decoder = new LtDecoder(header->symbols, header->length);
+        } // end if (decoder == NULL)
+        long start = Clock::now();
+        decoder->add(header->seq, msg + sizeof(FountainHeader));
+        decoding += Clock::now() - start;
+    } // end onSymbol(const char[], int)
+
+    void reportDone() {
+        FrameHeader fin;
+        fin.seq   = tag;
+        fin.flags = FRAME_DONE;
+        sock.sendTo((char*)&fin, sizeof(fin));
+        lastDone = Clock::now();
+    } // end reportDone()
+
+    Transport &sock;        // joined to the group
+    LtDecoder *decoder;     // made once the object's size is known
+    uint32_t   tag;         // names this receiver
+    long       lastDone;    // time the last FRAME_DONE went out
+    long       decoding;    // usec spent decoding
+};
+
+#endif
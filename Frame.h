@@ -0,0 +1,186 @@
+/*
+ * @file   Frame.h
+ * @brief  Declares the headers that the protocol engines place at the front
+ *          of every data frame and every acknowledgment.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _FRAME_H_
+#define _FRAME_H_
+
+#include <stdint.h>
+#include "UdpSocket.h"    // for MSGSIZE
+
+/**
+ * Leads every data frame, so message[0] of a frame is still its sequence
+ *  number as the original test harness expects.
+ */
+struct FrameHeader {
+    uint32_t seq;       // serial sequence number of this frame
+    uint32_t flags;     // FRAME_* bits
+};
+
+/**
+ * The whole of an acknowledgment. Acks are cumulative: ack names the next
+ *  sequence number the receiver expects, so every lower one has arrived.
+ */
+struct AckHeader {
+    uint32_t ack;       // next sequence number expected by the receiver
+    uint32_t flags;     // FRAME_* bits; FRAME_ACK is always set
+};
+
+// flags shared by the frame and ack headers, which all keep them in their
+//  second word, so a datagram arriving on a two-way socket can be told
+//  apart by its flags
+#define FRAME_ACK   0x01 // the datagram is an AckHeader
+#define FRAME_SKIP  0x02 // header only: every frame below seq is abandoned
+#define FRAME_PIGGY 0x04 // the frame leads with a DuplexHeader
+#define FRAME_LZ4   0x08 // the payload is one LZ4 block
+#define FRAME_SEAL  0x10 // the rest of the datagram is AEAD sealed
+#define FRAME_NACK  0x20 // the datagram is a NackHeader
+#define FRAME_TAIL  0x40 // header only: every frame below seq has been sent
+#define FRAME_CODED 0x80 // the frame leads with a FountainHeader
+#define FRAME_DONE  0x100 // header only: receiver seq has decoded the object
+#define FRAME_HARQ  0x200 // the datagram leads with a HarqHeader
+#define FRAME_CE    0x400 // set on receipt: the frame arrived marked CE
+#define FRAME_ECN   0x800 // the ack is an EcnAckHeader
+#define FRAME_STAMP 0x1000 // the header carries timestamps after its flags
+#define FRAME_STREAM 0x2000 // the ack is a StreamAckHeader; on a frame,
+                             //  header only: asks for the stream limits
+
+/**
+ * An AckHeader that also echoes ECN: ce counts every frame the receiver has
+ *  taken in marked Congestion Experienced, so the sender learns how many
+ *  were marked even if acks are lost or cover several frames. A receiver
+ *  sends it, with FRAME_ECN set, once it has seen a mark.
+ */
+struct EcnAckHeader {
+    uint32_t ack;       // next sequence number expected by the receiver
+    uint32_t flags;     // FRAME_* bits; FRAME_ACK and FRAME_ECN are set
+    uint32_t ce;        // frames received marked CE so far
+};
+
+/**
+ * Leads a frame whose sender timestamped it; FRAME_STAMP is set. Any header
+ *  may carry the stamp: it goes right after the flags word, and whatever
+ *  the header holds beyond its first two words follows it.
+ */
+struct StampHeader {
+    uint32_t seq;       // serial sequence number of this frame
+    uint32_t flags;     // FRAME_* bits
+    int64_t  sent;      // usec on the sender's clock the frame was sent
+};
+
+/**
+ * Leads an ack that echoes the stamp of the last frame received, with the
+ *  receiver's own times for when that frame arrived and when the ack left;
+ *  FRAME_STAMP is set. As with StampHeader, the rest of the ack follows.
+ */
+struct EchoHeader {
+    uint32_t ack;       // next sequence number expected by the receiver
+    uint32_t flags;     // FRAME_* bits
+    int64_t  echo;      // the sent stamp of that frame, on the sender's clock
+    int64_t  received;  // usec on the receiver's clock it arrived
+    int64_t  acked;     // and this ack left
+};
+
+/**
+ * Replaces the FrameHeader of a frame that also acknowledges the frames
+ *  flowing the other way on a two-way session; FRAME_PIGGY is set.
+ */
+struct DuplexHeader {
+    uint32_t seq;       // serial sequence number of this frame
+    uint32_t flags;     // FRAME_* bits
+    uint32_t ack;       // as AckHeader::ack, for the opposite direction
+};
+
+/**
+ * The whole of a negative acknowledgment, naming the frames a receiver
+ *  lacks among the NACKBITS that start at seq. A multicast receiver tags
+ *  it so the others can tell it from their own; a unicast one leaves 0.
+ */
+struct NackHeader {
+    uint32_t seq;       // first frame the receiver lacks
+    uint32_t flags;     // FRAME_* bits; FRAME_NACK is always set
+    uint32_t mask;      // bit i set if frame seq + i is lacking
+    uint32_t from;      // random tag of the receiver that sent it, or 0
+};
+
+#define NACKBITS 32     // frames one NackHeader can name
+
+/**
+ * Leads each encoded symbol of a fountain-coded object; FRAME_CODED is set.
+ *  The symbol's neighbors follow from seq and symbols alone, so a receiver
+ *  needs nothing else to decode it.
+ */
+struct FountainHeader {
+    uint32_t seq;       // symbol id, which seeds its degree and neighbors
+    uint32_t flags;     // FRAME_* bits
+    uint32_t symbols;   // source symbols the object was cut into
+    uint32_t length;    // bytes of the object
+};
+
+/**
+ * Leads each frame, and is the whole of each ack, on one of several
+ *  interleaved stop-and-wait channels; FRAME_HARQ is set. Message m goes
+ *  on channel m % channels, so the channel and its alternating bit are all
+ *  the receiver needs to put the messages back in order.
+ */
+struct HarqHeader {
+    uint16_t channel;   // stop-and-wait channel the frame belongs to
+    uint16_t bit;       // that channel's alternating bit, 0 or 1
+    uint32_t flags;     // FRAME_* bits
+};
+
+/**
+ * Leads the payload of a frame on a multiplexed connection, naming the
+ *  stream it belongs to and its place in that stream.
+ */
+struct StreamHeader {
+    uint32_t stream;    // stream number, below the connection's stream count
+    uint32_t seq;       // serial sequence number within the stream
+};
+
+#define STREAMMAX 16    // most streams one connection carries
+
+/**
+ * The whole of an ack on a multiplexed connection, FRAME_ACK and
+ *  FRAME_STREAM set. It acknowledges one message of one stream, not a
+ *  prefix of the connection, so a loss holds back no other frame, and it
+ *  grants each stream's sender the messages its reader has room for. Only
+ *  the limits of the connection's streams are sent.
+ */
+struct StreamAckHeader {
+    uint32_t seq;       // message of stream acknowledged
+    uint32_t flags;     // FRAME_* bits
+    uint32_t stream;    // stream of that message, or STREAMMAX for none
+    uint32_t limit[STREAMMAX];  // per stream, first message not yet granted
+};
+
+/**
+ * Leads each record a Coalescer packs into the payload of a frame.
+ */
+struct RecordHeader {
+    uint16_t length;    // bytes of the record that follows
+};
+
+// largest payload that fits in one MSGSIZE datagram behind the header
+#define PAYLOADSIZE ( MSGSIZE - (int)sizeof( FrameHeader ) )
+
+// largest payload of a frame that may carry a piggybacked ack
+#define DUPLEXPAYLOAD ( MSGSIZE - (int)sizeof( DuplexHeader ) )
+
+// largest payload of a frame on a stop-and-wait channel
+#define HARQPAYLOAD ( MSGSIZE - (int)sizeof( HarqHeader ) )
+
+// largest payload of a frame that carries a sender timestamp
+#define STAMPPAYLOAD ( MSGSIZE - (int)sizeof( StampHeader ) )
+
+// largest payload of a frame that also carries a StreamHeader
+#define STREAMPAYLOAD ( PAYLOADSIZE - (int)sizeof( StreamHeader ) )
+
+// largest record that fits alone in a frame
+#define RECORDSIZE ( PAYLOADSIZE - (int)sizeof( RecordHeader ) )
+
+#endif
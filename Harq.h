@@ -0,0 +1,253 @@
+/*
+ * @file   Harq.h
+ * @brief  Declares a sender and receiver that run several stop-and-wait
+ *          channels side by side on one socket, as hybrid ARQ does on a
+ *          radio link. Message m goes on channel m % channels; each channel
+ *          has one frame in transit at a time, told from the one before by
+ *          an alternating bit, and resends it alone when its own timer runs
+ *          out. With N channels up to N frames are in transit, so the link
+ *          fills almost as a sliding window of N does, yet neither end keeps
+ *          a sequence space: the receiver holds one frame per channel and
+ *          hands them over by taking the channels in turn. A frame arriving
+ *          while its channel's last one still waits on an earlier channel
+ *          is dropped unacknowledged and comes again on the next timeout.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _HARQ_H_
+#define _HARQ_H_
+
+#include <vector>
+
+#include "Engine.h"
+
+template <class Clock = TimerClock, class Transport = UdpSocket>
+class HarqSender {
+ public:
+    /**
+     * @param  sock  bound socket with a destination set.
+     * @param  channels  stop-and-wait channels to interleave.
+     * @pre    0 < channels <= 65535.
+     */
+    HarqSender(Transport &sock, int channels)
+        : sock(sock), chans(channels), frames(channels * MSGSIZE),
+          lengths(channels), sentAt(channels), busy(channels, false),
+          bits(channels, 0), next(0), retrans(0) { }
+
+    /**
+     * @return true if the channel the next message goes on is free.
+     */
+    bool canSend() const { return !busy[next % chans]; }
+
+    /**
+     * Sends msg[] on the next channel in turn.
+     * @param  length  bytes of msg[]; at most HARQPAYLOAD.
+     * @pre    canSend() is true.
+     */
+    void send(const char msg[], int length) {
+        int         c      = next++ % chans;
+        char       *frame  = &frames[c * MSGSIZE];
+        HarqHeader *header = (HarqHeader*)frame;
+        header->channel = c;
+        header->bit     = bits[c];
+        header->flags   = FRAME_HARQ;
+        memcpy(frame + sizeof(HarqHeader), msg, length);
+        lengths[c] = sizeof(HarqHeader) + length;
+        sentAt[c]  = Clock::now();
+        busy[c]    = true;
+        sock.sendTo(frame, lengths[c]);
+    } // end send(const char[], int)
+
+    /**
+     * Frees every channel whose frame an ack has come back for, and
+     *  resends the frame of each channel that has waited MAX_TIME.
+     */
+    void poll() {
+        HarqHeader heard[ACKBATCH];
+        int        sizes[ACKBATCH];
+        int        received;
+        do {
+            received = sock.recvBatch((char*)heard, sizeof(HarqHeader), sizes,
+                                      ACKBATCH);
+            for (int i = 0; i < received; ++i) {
+                int c = heard[i].channel;
+                if (sizes[i] >= (int)sizeof(HarqHeader) &&
+                    (heard[i].flags & FRAME_ACK) &&
+                    (heard[i].flags & FRAME_HARQ) && c < chans && busy[c] &&
+                    heard[i].bit == bits[c]) {
+                    busy[c] = false;
+                    bits[c] ^= 1;
+                } // end if (sizes[i] >= sizeof(HarqHeader)...)
+            } // end for (; i < received; )
+        } while (received == ACKBATCH);
+        long now = Clock::now();
+        for (int c = 0; c < chans; ++c) {
+            if (busy[c] && now - sentAt[c] > MAX_TIME) {
+                sentAt[c] = now;
+                sock.sendTo(&frames[c * MSGSIZE], lengths[c]);
+                ++retrans;
+            } // end if (busy[c]...)
+        } // end for (; c < chans; )
+    } // end poll()
+
+    /**
+     * Blocks until every channel is free.
+     */
+    void flush() {
+        for (int c = 0; c < chans; ++c) {
+            while (busy[c]) {
+                poll();
+            } // end while(busy[c])
+        } // end for (; c < chans; )
+    } // end flush()
+
+    /**
+     * Sends message[] max times, as the test harness does, and waits until
+     *  all of them are acknowledged.
+     * @return A count of the number of frames that were transmitted more
+     *          than once.
+     */
+    int transfer(const int max, int message[]) {
+        for (int msgNum = 0; msgNum < max; ++msgNum) {
+            while (!canSend()) {
+                poll();
+            } // end while(!canSend())
+            send((char*)message, HARQPAYLOAD);
+            poll();
+        } // end for (; msgNum < max; )
+        flush();
+        return retrans;
+    } // end transfer(const int, int[])
+
+    int channels() const { return chans; }
+    int retransmits() const { return retrans; }
+
+ private:
+    Transport        &sock;         // carries frames out and acks in
+    int               chans;        // stop-and-wait channels
+    std::vector<char> frames;       // the frame in transit on each channel
+    std::vector<int>  lengths;      // bytes of each of those frames
+    std::vector<long> sentAt;       // time each was last sent
+    std::vector<bool> busy;         // whether each channel awaits an ack
+    std::vector<int>  bits;         // alternating bit of each channel
+    uint32_t          next;         // messages sent so far
+    int               retrans;      // frames transmitted more than once
+};
+
+
+template <class Clock = TimerClock, class Transport = UdpSocket>
+class HarqReceiver {
+ public:
+    /**
+     * @param  sock  bound socket frames arrive on.
+     * @param  channels  stop-and-wait channels the sender interleaves.
+     */
+    HarqReceiver(Transport &sock, int channels)
+        : sock(sock), chans(channels), frames(channels * MSGSIZE),
+          lengths(channels, +EMPTY), bits(channels, 0), next(0),
+          dropped(0) { }
+
+    /**
+     * Blocks until a frame arrives, then keeps and acknowledges it.
+     * @return true if the frame was new and kept.
+     */
+    bool receive() {
+        char frame[MSGSIZE];
+        int  length = sock.recvFrom(frame, MSGSIZE);
+        return onFrame(frame, length);
+    } // end receive()
+
+    /**
+     * Keeps a frame that carries its channel's expected bit, if the
+     *  channel's last frame has been handed over, and acknowledges it. A
+     *  frame with the other bit was kept before and is acknowledged again;
+     *  one that finds its channel still full is dropped without an ack.
+     * @return true if the frame was new and kept.
+     */
+    bool onFrame(const char frame[], int length) {
+        const HarqHeader *header = (const HarqHeader*)frame;
+        int               c      = header->channel;
+        if (length < (int)sizeof(HarqHeader) ||
+            !(header->flags & FRAME_HARQ) || (header->flags & FRAME_ACK) ||
+            c >= chans) {
+            return false;                   // runt or stray
+        } // end if (length < sizeof(HarqHeader)...)
+        if (header->bit != bits[c]) {
+            sendAck(c, header->bit);        // its ack was lost
+            return false;
+        } // end if (header->bit != bits[c])
+        if (lengths[c] != EMPTY) {
+            ++dropped;                      // waits on an earlier channel
+            return false;
+        } // end if (lengths[c] != EMPTY)
+        memcpy(&frames[c * MSGSIZE], frame, length);
+        lengths[c] = length;
+        bits[c] ^= 1;
+        sendAck(c, header->bit);
+        return true;
+    } // end onFrame(const char[], int)
+
+    /**
+     * Copies the payload of the next message in order into msg[].
+     * @param  msg  container of at least HARQPAYLOAD bytes.
+     * @return Bytes of payload, or -1 if it has not arrived.
+     */
+    int deliver(char msg[]) {
+        int c = next % chans;
+        if (lengths[c] == EMPTY) {
+            return -1;
+        } // end if (lengths[c] == EMPTY)
+        int length = lengths[c] - sizeof(HarqHeader);
+        memcpy(msg, &frames[c * MSGSIZE] + sizeof(HarqHeader), length);
+        lengths[c] = EMPTY;
+        ++next;
+        return length;
+    } // end deliver(char[])
+
+    /**
+     * Receives and acknowledges frames until max messages have been
+     *  delivered, as the test harness does.
+     */
+    void transfer(const int max, int message[]) {
+        while (next < (uint32_t)max) {
+            receive();
+            while (deliver((char*)message) >= 0) { }
+        } // end while(next < max)
+    } // end transfer(const int, int[])
+
+    /**
+     * Acknowledges the sender's retransmissions once every message has
+     *  been delivered, until quiet usec pass with nothing arriving, so a
+     *  channel whose last ack was lost is answered rather than left to
+     *  resend forever.
+     */
+    void linger(long quiet) {
+        while (sock.pollRecvFrom(quiet) > 0) {
+            receive();
+        } // end while(sock.pollRecvFrom(quiet) > 0)
+    } // end linger(long)
+
+    int blocked() const { return dropped; }
+
+ private:
+    static const int EMPTY = -1;    // length of a channel holding nothing
+
+    void sendAck(int channel, int bit) {
+        HarqHeader ack;
+        ack.channel = channel;
+        ack.bit     = bit;
+        ack.flags   = FRAME_HARQ | FRAME_ACK;
+        sock.ackTo((char*)&ack, sizeof(ack));
+    } // end sendAck(int, int)
+
+    Transport        &sock;         // carries frames in and acks out
+    int               chans;        // stop-and-wait channels
+    std::vector<char> frames;       // the frame kept on each channel
+    std::vector<int>  lengths;      // bytes of each, or EMPTY
+    std::vector<int>  bits;         // bit each channel expects next
+    uint32_t          next;         // messages delivered so far
+    int               dropped;      // frames dropped on a full channel
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ * @file   LossySocket.h
+ * @brief  Declares a transport that wraps another and drops a fraction of
+ *          the datagrams it sends, so that loss recovery can be exercised on
+ *          a loopback or LAN path that never loses anything by itself.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _LOSSYSOCKET_H_
+#define _LOSSYSOCKET_H_
+
+#include <stdlib.h>
+
+template <class Transport>
+class LossySocket {
+ public:
+    /**
+     * @param  sock  transport that carries the datagrams not dropped.
+     * @param  lossRate  fraction of sendTo() and ackTo() datagrams dropped.
+     * @param  seed  makes the drop pattern repeatable.
+     */
+    LossySocket(Transport &sock, double lossRate, unsigned seed = 432)
+        : sock(sock), threshold((int)(lossRate * RAND_MAX)), seed(seed) { }
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+    int recvFrom(char msg[], int length) { return sock.recvFrom(msg, length); }
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        return sock.recvBatch(msgs, length, sizes, count);
+    } // end recvBatch(char[], int, int[], int)
+
+    /**
+     * Sends msg[], or pretends to and drops it.
+     */
+    int sendTo(char msg[], int length) {
+        return drop() ? length : sock.sendTo(msg, length);
+    } // end sendTo(char[], int)
+
+    /**
+     * Acks msg[], or pretends to and drops it.
+     */
+    int ackTo(char msg[], int length) {
+        return drop() ? length : sock.ackTo(msg, length);
+    } // end ackTo(char[], int)
+
+ private:
+    bool drop() { return rand_r(&seed) < threshold; }
+
+    Transport &sock;        // carries what survives
+    int        threshold;   // rand_r() below this drops
+    unsigned   seed;        // state of rand_r()
+};
+
+#endif
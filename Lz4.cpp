@@ -0,0 +1,182 @@
+/*
+ * @file   Lz4.cpp
+ * @brief  Implements the LZ4 block codec declared in Lz4.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "Lz4.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static const int MINMATCH     = 4;  // shortest match the format encodes
+static const int LASTLITERALS = 5;  // a block ends with this many literals
+static const int MFLIMIT      = 12; // no match starts this close to the end
+static const int HASHLOG      = 12; // log2 of match finder table entries
+
+static inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+} // end read32(const uint8_t*)
+
+static inline int hash(uint32_t v) {
+    return (v * 2654435761U) >> (32 - HASHLOG);
+} // end hash(uint32_t)
+
+/**
+ * Writes the 255-run extension of a length that overflowed its token nibble.
+ */
+static inline uint8_t *putLength(uint8_t *op, int length) {
+    for (; length >= 255; length -= 255) {
+        *op++ = 255;
+    } // end for (; length >= 255; )
+    *op++ = (uint8_t)length;
+    return op;
+} // end putLength(uint8_t*, int)
+
+/**
+ * Writes one sequence: literals from anchor, then a match of matchLen bytes
+ *  at offset back, or no match if matchLen < 0.
+ * @return The next output byte, or NULL if the sequence would not fit.
+ */
+static uint8_t *putSequence(uint8_t *op, const uint8_t *oend,
+                            const uint8_t *anchor, int litLen,
+                            int offset, int matchLen) {
+    // token, both length extensions and the offset at most
+    if (op + 1 + litLen / 255 + 1 + litLen + 2 + matchLen / 255 + 1 > oend) {
+        return NULL;
+    } // end if (op + 1 + litLen / 255...)
+    uint8_t *token = op++;
+    *token = (litLen >= 15 ? 15 : litLen) << 4;
+    if (litLen >= 15) {
+        op = putLength(op, litLen - 15);
+    } // end if (litLen >= 15)
+    memcpy(op, anchor, litLen);
+    op += litLen;
+    if (matchLen < 0) {
+        return op;                          // the closing literals
+    } // end if (matchLen < 0)
+    *op++ = offset & 0xff;
+    *op++ = offset >> 8;
+    *token |= matchLen >= 15 ? 15 : matchLen;
+    if (matchLen >= 15) {
+        op = putLength(op, matchLen - 15);
+    } // end if (matchLen >= 15)
+    return op;
+} // end putSequence(uint8_t*, const uint8_t*, const uint8_t*, int, int, int)
+
+
+/**
+ * Compresses src[] into one LZ4 block with a greedy single-probe match
+ *  finder.
+ * @param  srcLen  bytes of src[]; at most LZ4MAXINPUT.
+ * @param  dstCap  room in dst[].
+ * @return Bytes of the block, or 0 if it would not fit in dstCap bytes.
+ */
+int lz4Compress(const char src[], int srcLen, char dst[], int dstCap) {
+    const uint8_t *base     = (const uint8_t*)src;
+    const uint8_t *ip       = base;
+    const uint8_t *anchor   = base;
+    const uint8_t *end      = base + srcLen;
+    const uint8_t *mflimit  = end - MFLIMIT;
+    const uint8_t *matchEnd = end - LASTLITERALS;
+    uint8_t       *op       = (uint8_t*)dst;
+    const uint8_t *oend     = op + dstCap;
+    uint16_t       table[1 << HASHLOG];
+
+    if (srcLen < 0 || srcLen > LZ4MAXINPUT) {
+        return 0;
+    } // end if (srcLen < 0...)
+    memset(table, 0, sizeof(table));
+    while (srcLen > MFLIMIT && ip < mflimit) {
+        uint32_t       word = read32(ip);
+        int            h    = hash(word);
+        const uint8_t *ref  = base + table[h];
+        table[h] = ip - base;
+        if (ref >= ip || read32(ref) != word) {
+            ++ip;
+            continue;
+        } // end if (ref >= ip...)
+        const uint8_t *match = ip + MINMATCH;
+        const uint8_t *from  = ref + MINMATCH;
+        while (match < matchEnd && *match == *from) {
+            ++match;
+            ++from;
+        } // end while(match < matchEnd...)
+        op = putSequence(op, oend, anchor, ip - anchor, ip - ref,
+                         match - ip - MINMATCH);
+        if (op == NULL) {
+            return 0;
+        } // end if (op == NULL)
+        ip = anchor = match;
+    } // end while(srcLen > MFLIMIT...)
+    op = putSequence(op, oend, anchor, end - anchor, 0, -1);
+    return op == NULL ? 0 : op - (uint8_t*)dst;
+} // end lz4Compress(const char[], int, char[], int)
+
+
+/**
+ * Decompresses one LZ4 block, checking every length and offset against
+ *  the buffers so a corrupt block cannot overrun them.
+ * @param  dstCap  room in dst[].
+ * @return Bytes decompressed, or -1 if the block is malformed or too big.
+ */
+int lz4Decompress(const char src[], int srcLen, char dst[], int dstCap) {
+    const uint8_t *ip   = (const uint8_t*)src;
+    const uint8_t *iend = ip + srcLen;
+    uint8_t       *op   = (uint8_t*)dst;
+    uint8_t       *oend = op + dstCap;
+
+    while (ip < iend) {
+        int token  = *ip++;
+        int length = token >> 4;
+        if (length == 15) {
+            int more;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                } // end if (ip >= iend)
+                length += more = *ip++;
+            } while (more == 255);
+        } // end if (length == 15)
+        if (length > iend - ip || length > oend - op) {
+            return -1;
+        } // end if (length > iend - ip...)
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+        if (ip == iend) {
+            break;                          // the closing literals
+        } // end if (ip == iend)
+        if (iend - ip < 2) {
+            return -1;
+        } // end if (iend - ip < 2)
+        int offset = ip[0] | ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op - (uint8_t*)dst) {
+            return -1;
+        } // end if (offset == 0...)
+        length = token & 15;
+        if (length == 15) {
+            int more;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                } // end if (ip >= iend)
+                length += more = *ip++;
+            } while (more == 255);
+        } // end if (length == 15)
+        length += MINMATCH;
+        if (length > oend - op) {
+            return -1;
+        } // end if (length > oend - op)
+        const uint8_t *from = op - offset;
+        for (int i = 0; i < length; ++i) {
+            op[i] = from[i];                // may overlap what it writes
+        } // end for (; i < length; )
+        op += length;
+    } // end while(ip < iend)
+    return op - (uint8_t*)dst;
+} // end lz4Decompress(const char[], int, char[], int)
@@ -0,0 +1,20 @@
+/*
+ * @file   Lz4.h
+ * @brief  Declares a compressor and decompressor for the LZ4 block format,
+ *          sized for single frames: inputs are at most 64KB, so every match
+ *          offset fits the format's two bytes and the match finder needs
+ *          only a small table of 16-bit positions. Output is readable by
+ *          any LZ4 block decoder and the decoder reads any LZ4 block.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _LZ4_H_
+#define _LZ4_H_
+
+#define LZ4MAXINPUT 65535   // largest input lz4Compress() accepts
+
+int lz4Compress(const char src[], int srcLen, char dst[], int dstCap);
+int lz4Decompress(const char src[], int srcLen, char dst[], int dstCap);
+
+#endif
@@ -0,0 +1,127 @@
+/*
+ * @file   McastSocket.cpp
+ * @brief  Implements the multicast transport declared in McastSocket.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "McastSocket.h"
+
+static const int MCASTTTL = 1;      // hops a datagram may take, the LAN only
+static const int MCASTBUF = 1 << 22; // receive buffer bytes, to ride out
+                                     //  moments a receiver falls behind
+
+
+/**
+ * Opens a socket on port and joins group on the interface with address
+ *  ifAddr. Datagrams this socket sends loop back to members on this host.
+ * @param  port  UDP port every member uses.
+ * @param  group  IPv4 multicast address, e.g. 239.255.43.2.
+ * @param  ifAddr  address of the interface to send and join on.
+ */
+McastSocket::McastSocket(int port, const char group[], const char ifAddr[])
+    : sd(NULL_SD) {
+    struct ip_mreq membership;
+    struct in_addr local;
+    bzero((char*)&groupAddr, sizeof(groupAddr));
+    groupAddr.sin_family = AF_INET;
+    groupAddr.sin_port   = htons(port);
+    if (inet_pton(AF_INET, group, &groupAddr.sin_addr) != 1 ||
+        inet_pton(AF_INET, ifAddr, &local) != 1) {
+        cerr << "Cannot parse the multicast group or interface." << endl;
+        return;
+    } // end if (inet_pton(...) != 1...)
+    if ((sd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+        cerr << "Cannot open a UDP socket." << endl;
+        sd = NULL_SD;
+        return;
+    } // end if ((sd = socket(...)) < 0)
+
+    int on = 1;
+    unsigned char ttl = MCASTTTL, loop = 1;
+    struct sockaddr_in myAddr;
+    bzero((char*)&myAddr, sizeof(myAddr));
+    myAddr.sin_family      = AF_INET;
+    myAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    myAddr.sin_port        = htons(port);
+    membership.imr_multiaddr = groupAddr.sin_addr;
+    membership.imr_interface = local;
+    int buffer = MCASTBUF;
+    setsockopt(sd, SOL_SOCKET, SO_RCVBUF, &buffer, sizeof(buffer));
+    if (setsockopt(sd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+        bind(sd, (sockaddr*)&myAddr, sizeof(myAddr)) < 0 ||
+        setsockopt(sd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership,
+                   sizeof(membership)) < 0 ||
+        setsockopt(sd, IPPROTO_IP, IP_MULTICAST_IF, &local,
+                   sizeof(local)) < 0 ||
+        setsockopt(sd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        setsockopt(sd, IPPROTO_IP, IP_MULTICAST_LOOP, &loop,
+                   sizeof(loop)) < 0) {
+        cerr << "Cannot join the multicast group." << endl;
+        close(sd);
+        sd = NULL_SD;
+    } // end if (setsockopt(...) < 0...)
+} // end McastSocket(int, const char[], const char[])
+
+McastSocket::~McastSocket() {
+    if (sd != NULL_SD) {
+        close(sd);
+    } // end if (sd != NULL_SD)
+} // end ~McastSocket()
+
+
+/**
+ * Waits at most usec for a datagram to arrive.
+ * @return A positive number if a datagram is waiting, otherwise 0 or less.
+ */
+int McastSocket::pollRecvFrom(long usec) {
+    struct pollfd   pfd;
+    struct timespec timeout;
+    pfd.fd          = sd;
+    pfd.events      = POLLRDNORM;
+    timeout.tv_sec  = usec / 1000000;
+    timeout.tv_nsec = usec % 1000000 * 1000;
+    return ppoll(&pfd, 1, &timeout, NULL);
+} // end pollRecvFrom(long)
+
+
+/**
+ * Sends msg[] to every member of the group, this one included.
+ */
+int McastSocket::sendTo(char msg[], int length) {
+    return sendto(sd, msg, length, 0, (sockaddr*)&groupAddr,
+                  sizeof(groupAddr));
+} // end sendTo(char[], int)
+
+
+/**
+ * Blocks until a datagram from any member arrives.
+ */
+int McastSocket::recvFrom(char msg[], int length) {
+    return recv(sd, msg, length, 0);
+} // end recvFrom(char[], int)
+
+
+/**
+ * Takes every datagram already waiting, up to count, without blocking.
+ * @return How many arrived, 0 if none were waiting.
+ */
+int McastSocket::recvBatch(char msgs[], int length, int sizes[], int count) {
+    struct mmsghdr hdrs[count];
+    struct iovec   iovs[count];
+    bzero((char*)hdrs, sizeof(hdrs));
+    for (int i = 0; i < count; ++i) {
+        iovs[i].iov_base = msgs + i * length;
+        iovs[i].iov_len  = length;
+        hdrs[i].msg_hdr.msg_iov    = &iovs[i];
+        hdrs[i].msg_hdr.msg_iovlen = 1;
+    } // end for (; i < count; )
+    int received = recvmmsg(sd, hdrs, count, MSG_DONTWAIT, NULL);
+    if (received <= 0) {
+        return 0;
+    } // end if (received <= 0)
+    for (int i = 0; i < received; ++i) {
+        sizes[i] = hdrs[i].msg_len;
+    } // end for (; i < received; )
+    return received;
+} // end recvBatch(char[], int, int[], int)
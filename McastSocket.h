@@ -0,0 +1,37 @@
+/*
+ * @file   McastSocket.h
+ * @brief  Declares a transport with the interface of UdpSocket that sends
+ *          every datagram to an IPv4 multicast group and receives what any
+ *          member sends to it. The sender and every receiver of a one-to-
+ *          many transfer join the same group on the same port, so repairs
+ *          and NACKs reach everyone, which is what lets a receiver hear
+ *          another's NACK and keep quiet. Members share the port through
+ *          SO_REUSEADDR, so many can run on one host over loopback.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _MCASTSOCKET_H_
+#define _MCASTSOCKET_H_
+
+#include "UdpSocket.h"      // for MSGSIZE and NULL_SD
+
+class McastSocket {
+ public:
+    McastSocket(int port, const char group[],
+                const char ifAddr[] = "127.0.0.1");
+    ~McastSocket();
+    bool isOpen() const { return sd != NULL_SD; }
+    int  pollRecvFrom(long usec = 0);
+    int  sendTo(char msg[], int length);
+    int  recvFrom(char msg[], int length);
+    int  recvBatch(char msgs[], int length, int sizes[], int count);
+    int  ackTo(char msg[], int length) { return sendTo(msg, length); }
+    int  getDescriptor() { return sd; }
+
+ private:
+    int                sd;          // socket joined to the group
+    struct sockaddr_in groupAddr;   // where every datagram is sent
+};
+
+#endif
@@ -0,0 +1,348 @@
+/*
+ * @file   Multicast.h
+ * @brief  Declares reliable one-to-many distribution over a multicast
+ *          group. The sender paces frames out once and keeps the most
+ *          recent ones for repair; receivers never ack. A receiver that
+ *          sees a gap waits a random moment and then multicasts a NACK for
+ *          it, unless it first hears another receiver's NACK for the same
+ *          frame, so a loss every receiver shares costs about one NACK. The
+ *          sender gathers NACKs for a moment, resends each frame asked for
+ *          once, and ignores NACKs for a frame it has just repaired. When
+ *          it has nothing new to send, it multicasts a tail heartbeat so
+ *          that the loss of the last frames is noticed too. Receivers
+ *          reorder with a selective repeat ReceiverEngine whose acks go
+ *          nowhere.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _MULTICAST_H_
+#define _MULTICAST_H_
+
+#include <stdlib.h>
+#include <vector>
+
+#include "Engine.h"
+#include "McastSocket.h"
+
+static const long NACKWAIT    = 1000;   // usec a receiver waits at most
+                                        //  before NACKing a new gap
+static const long REPAIRWAIT  = 10000;  // usec before it NACKs it again
+static const long REPAIRDELAY = 500;    // usec the sender gathers NACKs
+static const long REPAIRHOLD  = 2000;   // usec a repaired frame is not
+                                        //  repaired again
+static const long HEARTBEAT   = 5000;   // usec between tail heartbeats
+
+template <class Clock = TimerClock, class Transport = McastSocket>
+class McastSender {
+ public:
+    /**
+     * @param  sock  transport joined to the group.
+     * @param  history  frames kept for repair.
+     * @param  interval  usec between new frames.
+     * @pre    history > 0.
+     */
+    McastSender(Transport &sock, int history, long interval)
+        : sock(sock), space(history), frames(space.size() * MSGSIZE),
+          lengths(space.size()), wanted(space.size(), false),
+          repairedAt(space.size(), 0), nextSeq(0), interval(interval),
+          lastSend(0), lastBeat(0), lastNack(0), repairDue(0), repairs(0),
+          nacks(0) { }
+
+    /**
+     * Multicasts msg[] once its turn comes, serving NACKs while it waits.
+     * @param  length  bytes of msg[]; at most PAYLOADSIZE.
+     * @return The sequence number given to the frame.
+     */
+    uint32_t send(const char msg[], int length) {
+        while (Clock::now() - lastSend < interval) {
+            poll();
+        } // end while(Clock::now() - lastSend < interval)
+        int   slot  = space.slot(nextSeq);
+        char *frame = &frames[slot * MSGSIZE];
+        ((FrameHeader*)frame)->seq   = nextSeq;
+        ((FrameHeader*)frame)->flags = 0;
+        memcpy(frame + sizeof(FrameHeader), msg, length);
+        lengths[slot]    = sizeof(FrameHeader) + length;
+        wanted[slot]     = false;
+        repairedAt[slot] = 0;
+        sock.sendTo(frame, lengths[slot]);
+        lastSend = Clock::now();
+        return nextSeq++;
+    } // end send(const char[], int)
+
+    /**
+     * Takes in NACKs, sends the repairs that have come due and a heartbeat
+     *  if nothing has gone out for a while. Never blocks.
+     */
+    void poll() {
+        static thread_local NackHeader heard[ACKBATCH];
+        int sizes[ACKBATCH];
+        int received;
+        do {
+            received = sock.recvBatch((char*)heard, sizeof(NackHeader), sizes,
+                                      ACKBATCH);
+            for (int i = 0; i < received; ++i) {
+                if (sizes[i] >= (int)sizeof(NackHeader) &&
+                    (heard[i].flags & FRAME_NACK)) {
+                    onNack(heard[i]);
+                } // end if (sizes[i] >= sizeof(NackHeader)...)
+            } // end for (; i < received; )
+        } while (received == ACKBATCH);
+        long now = Clock::now();
+        if (repairDue != 0 && now >= repairDue) {
+            repair(now);
+        } // end if (repairDue != 0...)
+        if (now - lastSend >= HEARTBEAT && now - lastBeat >= HEARTBEAT) {
+            FrameHeader beat;
+            beat.seq   = nextSeq;
+            beat.flags = FRAME_TAIL;
+            sock.sendTo((char*)&beat, sizeof(beat));
+            lastBeat = now;
+        } // end if (now - lastSend >= HEARTBEAT...)
+    } // end poll()
+
+    /**
+     * Keeps repairing until no receiver has NACKed for quiet usec, which
+     *  is all the sender can know of their completion.
+     */
+    void linger(long quiet) {
+        lastNack = Clock::now();
+        while (repairDue != 0 || Clock::now() - lastNack < quiet) {
+            poll();
+        } // end while(repairDue != 0...)
+    } // end linger(long)
+
+    int repaired() const { return repairs; }
+    int nacked() const { return nacks; }
+
+ private:
+    /**
+     * @return The oldest frame still kept for repair.
+     */
+    uint32_t oldest() const {
+        return nextSeq - (uint32_t)space.size() < nextSeq
+                   ? nextSeq - space.size() : 0;
+    } // end oldest()
+
+    /**
+     * Marks the frames a NACK names for the next repair, or tells the
+     *  receivers to skip what is no longer kept.
+     */
+    void onNack(const NackHeader &nack) {
+        long now = Clock::now();
+        bool gone = false;
+        ++nacks;
+        lastNack = now;
+        for (int i = 0; i < NACKBITS; ++i) {
+            uint32_t seq = nack.seq + i;
+            if (!(nack.mask & 1u << i) || !SeqSpace::before(seq, nextSeq)) {
+                continue;
+            } // end if (!(nack.mask & 1u << i)...)
+            if (SeqSpace::before(seq, oldest())) {
+                gone = true;
+                continue;
+            } // end if (SeqSpace::before(seq, oldest()))
+            int slot = space.slot(seq);
+            if (wanted[slot] || now - repairedAt[slot] < REPAIRHOLD) {
+                continue;                   // asked for or just sent
+            } // end if (wanted[slot]...)
+            wanted[slot] = true;
+            if (repairDue == 0) {
+                repairDue = now + REPAIRDELAY;
+            } // end if (repairDue == 0)
+        } // end for (; i < NACKBITS; )
+        if (gone) {
+            FrameHeader skip;
+            skip.seq   = oldest();
+            skip.flags = FRAME_SKIP;
+            sock.sendTo((char*)&skip, sizeof(skip));
+        } // end if (gone)
+    } // end onNack(const NackHeader&)
+
+    /**
+     * Resends every frame asked for since the last repair, oldest first.
+     */
+    void repair(long now) {
+        for (uint32_t seq = oldest(); seq != nextSeq; ++seq) {
+            int slot = space.slot(seq);
+            if (wanted[slot]) {
+                sock.sendTo(&frames[slot * MSGSIZE], lengths[slot]);
+                wanted[slot]     = false;
+                repairedAt[slot] = now;
+                ++repairs;
+            } // end if (wanted[slot])
+        } // end for (; seq != nextSeq; )
+        repairDue = 0;
+    } // end repair(long)
+
+    Transport        &sock;         // joined to the group
+    SeqSpace          space;        // maps sequence numbers to slots
+    std::vector<char> frames;       // the frames kept for repair
+    std::vector<int>  lengths;      // bytes of each kept frame
+    std::vector<bool> wanted;       // whether a NACK asked for the frame
+    std::vector<long> repairedAt;   // time each frame was last repaired
+    uint32_t          nextSeq;      // next sequence number to assign
+    long              interval;     // usec between new frames
+    long              lastSend;     // time the last new frame went out
+    long              lastBeat;     // time the last heartbeat went out
+    long              lastNack;     // time the last NACK was heard
+    long              repairDue;    // time to send the repairs, 0 if none
+    int               repairs;      // frames resent
+    int               nacks;        // NACKs heard
+};
+
+
+/**
+ * Swallows the acks of a ReceiverEngine that only NACKs.
+ */
+struct MuteAcks {
+    int ackTo(char[], int length) { return length; }
+};
+
+template <class Clock = TimerClock, class Transport = McastSocket>
+class McastReceiver {
+ public:
+    /**
+     * @param  sock  transport joined to the group.
+     * @param  windowSize  frames buffered out of order; no larger than the
+     *                      sender's history.
+     * @param  seed  varies the NACK timers of receivers started together.
+     */
+    McastReceiver(Transport &sock, int windowSize, unsigned seed)
+        : sock(sock), engine(mute, windowSize), highest(0), front(0),
+          nackAt(0),
+          seed(seed), tag(rand_r(&this->seed)), sent(0), suppressed(0) { }
+
+    /**
+     * Waits for one datagram from the group and takes it in, sending a
+     *  NACK on the way if one comes due. Sleeps while waiting, so that
+     *  receivers sharing a CPU leave it to the ones with work; Transport
+     *  must offer pollRecvFrom(usec) to bound the sleep by the NACK timer.
+     */
+    void receive() {
+        char dgram[MSGSIZE];
+        long now;
+        while (nackAt != 0 &&
+               sock.pollRecvFrom(nackAt > (now = Clock::now()) ? nackAt - now
+                                                                : 0) < 1) {
+            checkNack();
+        } // end while(nackAt != 0...)
+        onDatagram(dgram, sock.recvFrom(dgram, MSGSIZE));
+        checkNack();
+    } // end receive()
+
+    int deliver(char msg[]) { return engine.deliver(msg); }
+
+    /**
+     * Receives until max messages have been delivered in order or given up
+     *  because the sender no longer kept them.
+     */
+    void transfer(const int max, int message[]) {
+        for (int delivered = 0; delivered + engine.skipped() < max; ) {
+            receive();
+            while (deliver((char*)message) >= 0) {
+                ++delivered;
+            } // end while(deliver((char*)message) >= 0)
+        } // end for (; delivered + engine.skipped() < max; )
+    } // end transfer(const int, int[])
+
+    int nacks() const { return sent; }
+    int skipped() const { return engine.skipped(); }
+    int suppressions() const { return suppressed; }
+
+ private:
+    /**
+     * Takes in a frame, a heartbeat or another receiver's NACK, and starts
+     *  the NACK timer if this leaves a gap.
+     */
+    void onDatagram(char dgram[], int length) {
+        if (length < (int)sizeof(FrameHeader)) {
+            return;
+        } // end if (length < sizeof(FrameHeader))
+        const FrameHeader *header = (const FrameHeader*)dgram;
+        if (header->flags & FRAME_NACK) {
+            if (length >= (int)sizeof(NackHeader)) {
+                hear(*(const NackHeader*)dgram);
+            } // end if (length >= sizeof(NackHeader))
+            return;
+        } // end if (header->flags & FRAME_NACK)
+        if (header->flags & FRAME_TAIL) {
+            raise(header->seq);             // everything below was sent
+        } else {
+            engine.onFrame(dgram, length);
+            if (!(header->flags & FRAME_SKIP)) {
+                raise(header->seq + 1);
+            } // end if (!(header->flags & FRAME_SKIP))
+        } // end if (header->flags & FRAME_TAIL)
+        if (!gap()) {
+            nackAt = 0;
+        } else if (nackAt == 0 || engine.expected() != front) {
+            front  = engine.expected();     // a new gap, or the old one moved
+            nackAt = Clock::now() + rand_r(&seed) % NACKWAIT;
+        } // end if (!gap())
+    } // end onDatagram(char[], int)
+
+    /**
+     * Holds back this receiver's NACK if another one already asked for the
+     *  first frame it lacks.
+     */
+    void hear(const NackHeader &nack) {
+        uint32_t offset = engine.expected() - nack.seq;
+        if (nack.from != tag && nackAt != 0 && offset < NACKBITS &&
+            (nack.mask & 1u << offset)) {
+            nackAt = Clock::now() + REPAIRWAIT;
+            ++suppressed;
+        } // end if (nack.from != tag...)
+    } // end hear(const NackHeader&)
+
+    /**
+     * Once the timer runs out, multicasts a NACK for each run of NACKBITS
+     *  frames from the front of the window that lacks any, then waits for
+     *  the repairs.
+     */
+    void checkNack() {
+        if (nackAt == 0 || Clock::now() < nackAt) {
+            return;
+        } // end if (nackAt == 0...)
+        NackHeader nack;
+        nack.flags = FRAME_NACK;
+        nack.from  = tag;
+        for (nack.seq = engine.expected(); SeqSpace::before(nack.seq, highest);
+             nack.seq += NACKBITS) {
+            nack.mask = 0;
+            for (int i = 0; i < NACKBITS &&
+                            SeqSpace::before(nack.seq + i, highest); ++i) {
+                if (!engine.holds(nack.seq + i)) {
+                    nack.mask |= 1u << i;
+                } // end if (!engine.holds(nack.seq + i))
+            } // end for (; i < NACKBITS...)
+            if (nack.mask != 0) {
+                sock.sendTo((char*)&nack, sizeof(nack));
+                ++sent;
+            } // end if (nack.mask != 0)
+        } // end for (nack.seq = engine.expected()...)
+        nackAt = Clock::now() + REPAIRWAIT;
+    } // end checkNack()
+
+    bool gap() const { return SeqSpace::before(engine.expected(), highest); }
+    void raise(uint32_t seq) {
+        if (SeqSpace::before(highest, seq)) {
+            highest = seq;
+        } // end if (SeqSpace::before(highest, seq))
+    } // end raise(uint32_t)
+
+    Transport &sock;        // joined to the group
+    MuteAcks   mute;        // where the engine's acks go
+    ReceiverEngine<SelectiveRepeat, CumulativeAck, Clock, MuteAcks>
+               engine;      // reorders and delivers
+    uint32_t   highest;     // one past the highest frame known to exist
+    uint32_t   front;       // first frame lacking when nackAt was set
+    long       nackAt;      // time to NACK the gap, 0 if there is none
+    unsigned   seed;        // state of rand_r()
+    uint32_t   tag;         // marks this receiver's NACKs
+    int        sent;        // NACKs sent
+    int        suppressed;  // NACKs held back for another's
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*
+ * @file   Multipath.h
+ * @brief  Declares a transport that stripes one connection's frames across
+ *          several UDP sockets, each on its own port and so its own 5-tuple:
+ *          its own NIC queue, its own ECMP hash and, between multihomed
+ *          hosts, its own path. Each path keeps its own smoothed RTT and
+ *          congestion window, learned from the cumulative acks the engine
+ *          drains through it: an ack releases every frame below it from the
+ *          path that carried the frame and times the newest, and a frame
+ *          sent again is taken as a loss on the path that lost it, which
+ *          halves that path's window alone, once per round trip: losses of
+ *          frames sent before the cut belong to the same event, as in
+ *          NewReno. Each new frame goes to the path with the lowest RTT
+ *          that still has room in its window, so the fastest path fills
+ *          first and the others take the overflow. An engine that runs a
+ *          MultipathWindow sends only while some path has room, so the
+ *          paths' windows, not the engine's, bound what is in flight.
+ *          The receiver side listens on every path and acks on the one the
+ *          last frame came in on; the engine's receive window absorbs the
+ *          reordering between paths.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _MULTIPATH_H_
+#define _MULTIPATH_H_
+
+#include <vector>
+
+#include "Engine.h"
+
+static const int PATHWINDOW = 2;    // frames a path starts with in flight
+
+template <class Clock = TimerClock>
+class MultipathSocket {
+ public:
+    /**
+     * Opens count sockets on ports port to port + count - 1.
+     * @param  windowSize  window of the engine running over these paths.
+     * @pre    count > 0 and windowSize > 0.
+     */
+    MultipathSocket(int port, int count, int windowSize)
+        : space(windowSize), pathOf(space.size(), +NONE),
+          sentAt(space.size()), resent(space.size()), acked(0), highest(0),
+          last(0), turn(0) {
+        for (int p = 0; p < count; ++p) {
+            paths.push_back(Path(new UdpSocket(port + p)));
+        } // end for (; p < count; )
+    } // end MultipathSocket(int, int, int)
+
+    ~MultipathSocket() {
+        for (size_t p = 0; p < paths.size(); ++p) {
+            delete paths[p].sock;
+        } // end for (; p < paths.size(); )
+    } // end ~MultipathSocket()
+
+    /**
+     * Points every path at the same port on ipName as it is bound to.
+     */
+    bool setDestAddress(char ipName[]) {
+        for (size_t p = 0; p < paths.size(); ++p) {
+            if (!paths[p].sock->setDestAddress(ipName)) {
+                return false;
+            } // end if (!paths[p].sock->setDestAddress(ipName))
+        } // end for (; p < paths.size(); )
+        return true;
+    } // end setDestAddress(char[])
+
+    /**
+     * Sends a frame on the path picked for it. A frame sent again counts
+     *  as lost on the path that carried it before.
+     */
+    int sendTo(char frame[], int length) {
+        const FrameHeader *header = (const FrameHeader*)frame;
+        if (length < (int)sizeof(FrameHeader) ||
+            (header->flags & FRAME_SKIP)) {
+            return paths[0].sock->sendTo(frame, length);
+        } // end if (length < sizeof(FrameHeader)...)
+        int slot = space.slot(header->seq);
+        if (pathOf[slot] != NONE) {
+            onLoss(paths[pathOf[slot]], header->seq);
+            resent[slot] = true;
+        } else {
+            resent[slot] = false;
+        } // end if (pathOf[slot] != NONE)
+        if (!SeqSpace::before(header->seq, highest)) {
+            highest = header->seq + 1;
+        } // end if (!SeqSpace::before(header->seq, highest))
+        int p = pick();
+        pathOf[slot] = p;
+        sentAt[slot] = Clock::now();
+        ++paths[p].inFlight;
+        ++paths[p].frames;
+        return paths[p].sock->sendTo(frame, length);
+    } // end sendTo(char[], int)
+
+    /**
+     * Acks the last frame received, on the path it came in on.
+     */
+    int ackTo(char msg[], int length) {
+        return paths[last].sock->ackTo(msg, length);
+    } // end ackTo(char[], int)
+
+    /**
+     * Waits up to usec for a datagram on any path.
+     * @return Positive if one is waiting, 0 if none came in time.
+     */
+    int pollRecvFrom(long usec = 0) {
+        struct pollfd   fds[paths.size()];
+        struct timespec timeout;
+        for (size_t p = 0; p < paths.size(); ++p) {
+            fds[p].fd     = paths[p].sock->getDescriptor();
+            fds[p].events = POLLRDNORM;
+        } // end for (; p < paths.size(); )
+        timeout.tv_sec  = usec > 0 ? usec / 1000000 : 0;
+        timeout.tv_nsec = usec > 0 ? usec % 1000000 * 1000 : 0;
+        return ppoll(fds, paths.size(), &timeout, NULL);
+    } // end pollRecvFrom(long)
+
+    /**
+     * Blocks until a datagram arrives on any path, taking the paths in
+     *  turn so none is starved.
+     */
+    int recvFrom(char msg[], int length) {
+        int sizes[1];
+        while (true) {
+            for (size_t i = 0; i < paths.size(); ++i) {
+                int p = turn;
+                turn  = (turn + 1) % paths.size();
+                if (paths[p].sock->recvBatch(msg, length, sizes, 1) == 1) {
+                    onDatagram(p, msg, sizes[0]);
+                    return sizes[0];
+                } // end if (paths[p].sock->recvBatch(...) == 1)
+            } // end for (; i < paths.size(); )
+            pollRecvFrom(MAX_TIME);
+        } // end while(true)
+    } // end recvFrom(char[], int)
+
+    /**
+     * Takes every datagram already waiting on any path, up to count.
+     */
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        int received = 0;
+        for (size_t p = 0; p < paths.size() && received < count; ++p) {
+            int got = paths[p].sock->recvBatch(msgs + received * length,
+                                               length, sizes + received,
+                                               count - received);
+            for (int i = received; i < received + got; ++i) {
+                onDatagram(p, msgs + i * length, sizes[i]);
+            } // end for (; i < received + got; )
+            received += got;
+        } // end for (; p < paths.size()...)
+        return received;
+    } // end recvBatch(char[], int, int[], int)
+
+    /**
+     * @return Frames every path's window together lets be in flight. Each
+     *          frame in flight is counted on exactly one path, so while the
+     *          engine has fewer than this in flight some path has room.
+     */
+    int window() const {
+        int total = 0;
+        for (size_t p = 0; p < paths.size(); ++p) {
+            total += (int)paths[p].cwnd;
+        } // end for (; p < paths.size(); )
+        return total;
+    } // end window()
+
+    int    count() const { return paths.size(); }
+    int    frames(int p) const { return paths[p].frames; }
+    int    losses(int p) const { return paths[p].losses; }
+    long   srtt(int p) const { return paths[p].srtt; }
+    double cwnd(int p) const { return paths[p].cwnd; }
+
+ private:
+    static const int NONE = -1;     // path of a slot with no frame in flight
+
+    struct Path {
+        Path(UdpSocket *sock)
+            : sock(sock), srtt(0), cwnd(PATHWINDOW), ssthresh(1e9),
+              inFlight(0), frames(0), losses(0), recover(0), cut(false) { }
+        UdpSocket *sock;        // bound to this path's port
+        long       srtt;        // smoothed RTT in usec, 0 until sampled
+        double     cwnd;        // frames this path may have in flight
+        double     ssthresh;    // cwnd below which it grows per ack
+        int        inFlight;    // frames sent on it and not yet acked
+        int        frames;      // frames sent on it, resends included
+        int        losses;      // frames it lost
+        uint32_t   recover;     // frames below it were sent before the cut
+        bool       cut;         // whether the window has ever been cut
+    };
+
+    /**
+     * @return The path with room in its window and the lowest RTT, or the
+     *          least loaded if every window is full, as it can be for a
+     *          resend, which no window holds back.
+     */
+    int pick() const {
+        int best = -1;
+        for (size_t p = 0; p < paths.size(); ++p) {
+            if (paths[p].inFlight < paths[p].cwnd &&
+                (best < 0 || paths[p].srtt < paths[best].srtt)) {
+                best = p;
+            } // end if (paths[p].inFlight < paths[p].cwnd...)
+        } // end for (; p < paths.size(); )
+        if (best >= 0) {
+            return best;
+        } // end if (best >= 0)
+        best = 0;
+        for (size_t p = 1; p < paths.size(); ++p) {
+            if (paths[p].inFlight * paths[best].cwnd <
+                paths[best].inFlight * paths[p].cwnd) {
+                best = p;
+            } // end if (paths[p].inFlight * ...)
+        } // end for (; p < paths.size(); )
+        return best;
+    } // end pick()
+
+    /**
+     * Notes which path a datagram came in on and, if it is an ack,
+     *  releases the frames it covers from their paths.
+     */
+    void onDatagram(int p, const char msg[], int size) {
+        last = p;
+        const AckHeader *ack = (const AckHeader*)msg;
+        if (size < (int)sizeof(AckHeader) || !(ack->flags & FRAME_ACK) ||
+            !SeqSpace::before(acked, ack->ack) ||
+            SeqSpace::before(acked + space.size(), ack->ack)) {
+            return;                         // a frame, or an old ack
+        } // end if (size < sizeof(AckHeader)...)
+        long now  = Clock::now();
+        int  slot = space.slot(ack->ack - 1);
+        if (pathOf[slot] != NONE && !resent[slot]) {
+            Path &timed = paths[pathOf[slot]];  // Karn: first sends only
+            long  rtt   = now - sentAt[slot];
+            timed.srtt  = timed.srtt == 0 ? rtt : (7 * timed.srtt + rtt) / 8;
+        } // end if (pathOf[slot] != NONE...)
+        for (; acked != ack->ack; ++acked) {
+            slot = space.slot(acked);
+            if (pathOf[slot] != NONE) {
+                onAcked(paths[pathOf[slot]]);
+                pathOf[slot] = NONE;
+            } // end if (pathOf[slot] != NONE)
+        } // end for (; acked != ack->ack; )
+    } // end onDatagram(int, const char[], int)
+
+    /**
+     * Grows a path's window by one frame per frame acked in slow start
+     *  and by one frame per window after.
+     */
+    void onAcked(Path &path) {
+        --path.inFlight;
+        path.cwnd += path.cwnd < path.ssthresh ? 1 : 1 / path.cwnd;
+    } // end onAcked(Path&)
+
+    /**
+     * Halves a path's window for the loss of frame seq, unless a frame
+     *  sent after the last cut has yet to be lost: one timeout resends a
+     *  whole window, but that is one loss event, not a window of them.
+     */
+    void onLoss(Path &path, uint32_t seq) {
+        --path.inFlight;
+        ++path.losses;
+        if (path.cut && SeqSpace::before(seq, path.recover)) {
+            return;                         // same event as the last cut
+        } // end if (path.cut...)
+        path.ssthresh = path.cwnd / 2 > 1 ? path.cwnd / 2 : 1;
+        path.cwnd     = path.ssthresh;
+        path.recover  = highest;
+        path.cut      = true;
+    } // end onLoss(Path&, uint32_t)
+
+    std::vector<Path> paths;        // one per port
+    SeqSpace          space;        // maps sequence numbers to slots
+    std::vector<int>  pathOf;       // path each frame in flight went on
+    std::vector<long> sentAt;       // time each frame was last sent
+    std::vector<bool> resent;       // whether each frame was sent again
+    uint32_t          acked;        // frames below it have been acked
+    uint32_t          highest;      // one past the highest frame sent
+    int               last;         // path the last datagram came in on
+    int               turn;         // path recvFrom() tries first
+};
+
+
+/**
+ * A congestion controller that leaves the window to the paths of a
+ *  MultipathSocket: the engine may have as many frames in flight as the
+ *  paths' windows add up to, so it stops sending once every path is full.
+ *  Until attach() it holds the window the engine was built with.
+ */
+template <class Clock = TimerClock>
+class MultipathWindow {
+ public:
+    void init(int windowSize) { ceiling = windowSize; paths = NULL; }
+    void warm(int) { }
+    void attach(const MultipathSocket<Clock> &sock) { paths = &sock; }
+
+    int window() const {
+        int room = paths == NULL ? ceiling : paths->window();
+        return room < 1 ? 1 : room > ceiling ? ceiling : room;
+    } // end window()
+
+    void onAck(const AckSample &) { }
+    void onTimeout() { }
+
+ private:
+    int                            ceiling;    // most frames ever allowed
+    const MultipathSocket<Clock>  *paths;      // whose windows bound it
+};
+
+#endif
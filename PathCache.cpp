@@ -0,0 +1,266 @@
+/*
+ * @file   PathCache.cpp
+ * @brief  Implements the per-destination path metrics cache declared in
+ *          PathCache.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "PathCache.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+static const uint32_t PATHMAGIC = 0x31485450;   // "PTH1", this layout
+static const int      PATHSPINS = 1000;         // yields before a version
+                                                //  still odd is a dead writer
+
+/**
+ * What one entry holds besides its version word.
+ */
+struct PathRecord {
+    uint8_t key[16];        // peer's IPv6 or v4-mapped address, port aside
+    int64_t updated;        // seconds since the epoch when stored, 0 if free
+    int64_t srtt;           // as in PathMetrics
+    int64_t rttvar;
+    double  bandwidth;
+    int32_t window;
+};
+
+struct PathEntry {
+    std::atomic<uint32_t> version;  // odd while a writer holds the entry
+    PathRecord            record;
+};
+
+struct PathFile {
+    std::atomic<uint32_t> magic;    // PATHMAGIC, or 0 in a new file
+    uint32_t              slots;    // PATHSLOTS
+    PathEntry             entries[PATHSLOTS];
+};
+
+
+/**
+ * Fills key[] with the address of peer, IPv4 as v4-mapped IPv6, so a peer
+ *  reached by either family under one address has one entry.
+ * @return false if peer is of neither family.
+ */
+static bool keyOf(const struct sockaddr_storage &peer, uint8_t key[16]) {
+    if (peer.ss_family == AF_INET6) {
+        memcpy(key, &((const sockaddr_in6*)&peer)->sin6_addr, 16);
+        return true;
+    } // end if (peer.ss_family == AF_INET6)
+    if (peer.ss_family == AF_INET) {
+        memset(key, 0, 10);
+        key[10] = key[11] = 0xff;
+        memcpy(key + 12, &((const sockaddr_in*)&peer)->sin_addr, 4);
+        return true;
+    } // end if (peer.ss_family == AF_INET)
+    return false;
+} // end keyOf(const sockaddr_storage&, uint8_t[])
+
+
+/**
+ * Copies an entry's record, retrying while a writer holds it or if one
+ *  took it during the copy. A version odd for PATHSPINS tries in a row
+ *  was left so by a process that died mid-write, and the entry reads as
+ *  free, since the file outlives every process.
+ */
+static PathRecord readEntry(PathEntry &entry) {
+    PathRecord copy;
+    for (int spins = 0;;) {
+        uint32_t before = entry.version.load(std::memory_order_acquire);
+        if (before & 1) {
+            if (++spins == PATHSPINS) {
+                memset(&copy, 0, sizeof(copy));
+                return copy;                // wedged: as good as free
+            } // end if (++spins == PATHSPINS)
+            sched_yield();
+            continue;
+        } // end if (before & 1)
+        memcpy(&copy, &entry.record, sizeof(copy));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (entry.version.load(std::memory_order_relaxed) == before) {
+            return copy;
+        } // end if (entry.version.load(...) == before)
+    } // end for (;;)
+} // end readEntry(PathEntry&)
+
+
+/**
+ * Takes an entry for writing, waiting out any other writer for up to
+ *  PATHSPINS tries; one that holds it longer died mid-write, and the entry
+ *  is taken over from it, odd to odd.
+ * @return The version to release it with.
+ */
+static uint32_t lockEntry(PathEntry &entry) {
+    for (int spins = 0;; ++spins) {
+        uint32_t version = entry.version.load(std::memory_order_relaxed);
+        bool     wedged  = (version & 1) && spins >= PATHSPINS;
+        uint32_t locked  = version + (wedged ? 2 : 1);
+        if ((!(version & 1) || wedged) &&
+            entry.version.compare_exchange_weak(version, locked,
+                                                std::memory_order_acquire)) {
+            return locked + 1;
+        } // end if ((!(version & 1) || wedged)...)
+        sched_yield();
+    } // end for (; ; ++spins)
+} // end lockEntry(PathEntry&)
+
+
+/**
+ * Writes record over an entry.
+ */
+static void writeEntry(PathEntry &entry, const PathRecord &record) {
+    uint32_t release = lockEntry(entry);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&entry.record, &record, sizeof(record));
+    entry.version.store(release, std::memory_order_release);
+} // end writeEntry(PathEntry&, const PathRecord&)
+
+
+static bool isFresh(const PathRecord &record, int64_t now) {
+    return record.updated != 0 && now - record.updated <= PATHAGE;
+} // end isFresh(const PathRecord&, int64_t)
+
+
+/**
+ * Opens the cache at path, creating it if need be. An existing file is
+ *  only sized if it is empty, so one that is not a cache is never touched.
+ * @param  path  file every process that shares the cache names.
+ */
+PathCache::PathCache(const char path[]) : fd(-1), file(NULL) {
+    struct stat status;
+    if ((fd = open(path, O_RDWR | O_CREAT, 0644)) < 0 ||
+        fstat(fd, &status) < 0 ||
+        (status.st_size == 0 && ftruncate(fd, sizeof(PathFile)) < 0)) {
+        cerr << "Cannot open the path cache." << endl;
+        return;
+    } // end if ((fd = open(...)) < 0...)
+    if (status.st_size != 0 && status.st_size != sizeof(PathFile)) {
+        cerr << path << " is not a path cache." << endl;
+        return;
+    } // end if (status.st_size != 0...)
+    void *base = mmap(NULL, sizeof(PathFile), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        cerr << "Cannot map the path cache." << endl;
+        return;
+    } // end if (base == MAP_FAILED)
+    file = (PathFile*)base;
+    uint32_t magic = 0;
+    if (file->magic.compare_exchange_strong(magic, PATHMAGIC)) {
+        file->slots = PATHSLOTS;
+    } else if (magic != PATHMAGIC) {
+        cerr << "The path cache has another layout." << endl;
+        munmap(file, sizeof(PathFile));
+        file = NULL;
+    } // end if (file->magic.compare_exchange_strong(...))
+} // end PathCache(const char[])
+
+
+PathCache::~PathCache() {
+    if (file != NULL) {
+        munmap(file, sizeof(PathFile));
+    } // end if (file != NULL)
+    if (fd >= 0) {
+        close(fd);
+    } // end if (fd >= 0)
+} // end ~PathCache()
+
+
+/**
+ * Looks up what the cache knows of peer.
+ * @return true if it knows something stored within PATHAGE.
+ */
+bool PathCache::lookup(const struct sockaddr_storage &peer,
+                       PathMetrics &metrics) {
+    uint8_t key[16];
+    if (file == NULL || !keyOf(peer, key)) {
+        return false;
+    } // end if (file == NULL...)
+    PathEntry *entry = find(key, false);
+    if (entry == NULL) {
+        return false;
+    } // end if (entry == NULL)
+    PathRecord record = readEntry(*entry);
+    if (memcmp(record.key, key, sizeof(key)) != 0 ||
+        !isFresh(record, time(NULL))) {
+        return false;                       // replaced since it was found
+    } // end if (memcmp(...) != 0...)
+    metrics.srtt      = record.srtt;
+    metrics.rttvar    = record.rttvar;
+    metrics.bandwidth = record.bandwidth;
+    metrics.window    = record.window;
+    return true;
+} // end lookup(const sockaddr_storage&, PathMetrics&)
+
+
+/**
+ * Stores metrics for peer over whatever was known of it. A newer session
+ *  knows the path as it is now, so nothing is averaged with the old.
+ */
+void PathCache::store(const struct sockaddr_storage &peer,
+                      const PathMetrics &metrics) {
+    PathRecord record;
+    if (file == NULL || !keyOf(peer, record.key)) {
+        return;
+    } // end if (file == NULL...)
+    record.updated   = time(NULL);
+    record.srtt      = metrics.srtt;
+    record.rttvar    = metrics.rttvar;
+    record.bandwidth = metrics.bandwidth;
+    record.window    = metrics.window;
+    writeEntry(*find(record.key, true), record);
+} // end store(const sockaddr_storage&, const PathMetrics&)
+
+
+/**
+ * Drops what the cache knows of peer, so the next session starts cold.
+ */
+void PathCache::forget(const struct sockaddr_storage &peer) {
+    uint8_t key[16];
+    if (file == NULL || !keyOf(peer, key)) {
+        return;
+    } // end if (file == NULL...)
+    PathEntry *entry = find(key, false);
+    if (entry != NULL) {
+        PathRecord record;
+        memset(&record, 0, sizeof(record));
+        writeEntry(*entry, record);
+    } // end if (entry != NULL)
+} // end forget(const sockaddr_storage&)
+
+
+/**
+ * Finds the entry for key among the PATHPROBE slots from where it hashes.
+ * @param  claim  whether to settle, if key has none, for the first free or
+ *                 stale slot, or else the one stored longest ago.
+ * @return The entry, or NULL if key has none and claim is false.
+ */
+PathEntry *PathCache::find(const uint8_t key[16], bool claim) {
+    uint32_t hash = 2166136261u;            // FNV-1a
+    for (int i = 0; i < 16; ++i) {
+        hash = (hash ^ key[i]) * 16777619u;
+    } // end for (; i < 16; )
+    int64_t    now    = time(NULL);
+    PathEntry *victim = NULL;
+    int64_t    oldest = 0;
+    for (int i = 0; i < PATHPROBE; ++i) {
+        PathEntry &entry  = file->entries[(hash + i) % PATHSLOTS];
+        PathRecord record = readEntry(entry);
+        if (memcmp(record.key, key, sizeof(record.key)) == 0 &&
+            record.updated != 0) {
+            return &entry;
+        } // end if (memcmp(...) == 0...)
+        int64_t age = isFresh(record, now) ? record.updated : 0;
+        if (victim == NULL || age < oldest) {
+            victim = &entry;
+            oldest = age;
+        } // end if (victim == NULL...)
+    } // end for (; i < PATHPROBE; )
+    return claim ? victim : NULL;
+} // end find(const uint8_t[], bool)
@@ -0,0 +1,103 @@
+/*
+ * @file   PathCache.h
+ * @brief  Declares a cache of what sessions learned about each peer they
+ *          sent to: smoothed RTT, its variance, the bottleneck bandwidth
+ *          and the window that fills the path, keyed by the peer's resolved
+ *          address. It lives in a small file mapped into every process that
+ *          opens it, so a new session, in this process or a later one, can
+ *          start at an informed window and timeout instead of from nothing.
+ *          Each entry is guarded by a version word that is odd while it is
+ *          written: writers take it by compare-and-swap and readers retry a
+ *          copy that straddled a write, so neither ever blocks the other
+ *          for longer than a copy. Entries past PATHAGE are ignored.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _PATHCACHE_H_
+#define _PATHCACHE_H_
+
+#include <stdint.h>
+
+#include "Engine.h"
+
+static const int  PATHSLOTS  = 256;         // peers the file holds
+static const int  PATHPROBE  = 8;           // slots searched for a peer
+static const long PATHAGE    = 3600;        // seconds an entry stays good
+
+#define PATHCACHE "/tmp/css432.paths"   // the cache every session shares
+
+/**
+ * What a session learned about the path to its peer.
+ */
+struct PathMetrics {
+    long   srtt;        // smoothed RTT in usec
+    long   rttvar;      // mean deviation of the RTT in usec
+    double bandwidth;   // bytes/sec the bottleneck delivers
+    int    window;      // frames in transit that keep the path busy
+};
+
+struct PathEntry;
+struct PathFile;
+
+class PathCache {
+ public:
+    PathCache(const char path[]);
+    ~PathCache();
+    bool isOpen() const { return file != NULL; }
+    bool lookup(const struct sockaddr_storage &peer, PathMetrics &metrics);
+    void store(const struct sockaddr_storage &peer,
+               const PathMetrics &metrics);
+    void forget(const struct sockaddr_storage &peer);
+
+    /**
+     * Starts an engine that has sent nothing from what the cache knows of
+     *  the peer sock sends to: the window that filled the path, and the
+     *  RTT and deviation its timeout follows from then on.
+     * @return true if the peer was known.
+     */
+    template <class Engine>
+    bool warm(UdpSocket &sock, Engine &engine) {
+        struct sockaddr_storage peer;
+        PathMetrics             metrics;
+        if (sock.getDestAddress(&peer) == 0 || !lookup(peer, metrics)) {
+            return false;
+        } // end if (sock.getDestAddress(&peer) == 0...)
+        engine.warm(metrics.window, metrics.srtt, metrics.rttvar);
+        return true;
+    } // end warm(UdpSocket&, Engine&)
+
+    /**
+     * Stores what an engine learned of the peer sock sends to, once it has
+     *  taken an RTT sample. The window is the larger of the bandwidth-delay
+     *  product and the window the controller ended at: the one covers a
+     *  path whose controller never opened fully, the other one whose acks
+     *  come back batched, so the RTT sampled understates the BDP.
+     * @return The metrics stored.
+     */
+    template <class Engine>
+    PathMetrics remember(UdpSocket &sock, Engine &engine) {
+        struct sockaddr_storage peer;
+        PathMetrics             metrics;
+        metrics.srtt      = engine.smoothedRtt();
+        metrics.rttvar    = engine.rttVariance();
+        metrics.bandwidth = engine.estimator().bandwidth();
+        metrics.window    = (int)(metrics.bandwidth * metrics.srtt / 1e6 /
+                                  MSGSIZE) + 1;
+        if (engine.controller().window() > metrics.window) {
+            metrics.window = engine.controller().window();
+        } // end if (engine.controller().window() > metrics.window)
+        if (metrics.srtt > 0 && sock.getDestAddress(&peer) != 0) {
+            store(peer, metrics);
+        } // end if (metrics.srtt > 0...)
+        return metrics;
+    } // end remember(UdpSocket&, Engine&)
+
+ private:
+    PathEntry *find(const uint8_t key[16], bool claim);
+
+    int       fd;           // the cache file
+    PathFile *file;         // mapped over it, NULL if it would not open
+};
+
+#endif
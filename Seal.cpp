@@ -0,0 +1,264 @@
+/*
+ * @file   Seal.cpp
+ * @brief  Implements the AEAD frame protection declared in Seal.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "Seal.h"
+
+#include <string.h>
+#include <sys/random.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+static const int SEALAAD = sizeof(FrameHeader); // header bytes in the clear
+static const int SEALIV  = 12;          // bytes of the AEAD's nonce
+
+// HKDF info that tells the two directions' keys apart
+static const char *sealLabel[] = { "css432 seal initiator",
+                                   "css432 seal responder" };
+
+
+/**
+ * Keys a cipher context for this end's session and readies the others.
+ * @param  key  secret shared with the peer.
+ * @param  role  this end; the peer must take the other.
+ * @param  cipher  AEAD both sides use.
+ */
+Sealer::Sealer(const unsigned char key[SEALKEY], SealRole role,
+               SealCipher cipher)
+    : aead(cipher == AESGCM ? EVP_aes_256_gcm() : EVP_chacha20_poly1305()),
+      role(role), enc(EVP_CIPHER_CTX_new()), trial(EVP_CIPHER_CTX_new()),
+      session(0), sealed(0), retiring(0), tried(0), keyed(false),
+      derived(0), opens(0), replayed(0) {
+    memcpy(secret, key, SEALKEY);
+    memset(peers, 0, sizeof(peers));
+    memset(retired, 0, sizeof(retired));
+    for (int i = 0; i < SEALSESSIONS; ++i) {
+        peers[i].ctx = EVP_CIPHER_CTX_new();
+    } // end for (; i < SEALSESSIONS; )
+    if (getrandom(&session, sizeof(session), 0) != sizeof(session)) {
+        cerr << "Cannot draw a random session id." << endl;
+    } // end if (getrandom(...) != sizeof(session))
+    derive(enc, session, role, true);
+} // end Sealer(const unsigned char[], SealRole, SealCipher)
+
+Sealer::~Sealer() {
+    EVP_CIPHER_CTX_free(enc);
+    EVP_CIPHER_CTX_free(trial);
+    for (int i = 0; i < SEALSESSIONS; ++i) {
+        EVP_CIPHER_CTX_free(peers[i].ctx);
+    } // end for (; i < SEALSESSIONS; )
+    OPENSSL_cleanse(secret, SEALKEY);
+} // end ~Sealer()
+
+
+/**
+ * Seals a frame or an ack: its header stays readable but authenticated,
+ *  and the rest is encrypted.
+ * @param  in  datagram of length bytes, led by a FrameHeader or AckHeader.
+ * @param  out  container of at least length + SEALOVERHEAD bytes.
+ * @return Bytes of the sealed datagram in out[].
+ */
+int Sealer::seal(const char in[], int length, char out[]) {
+    unsigned char *o = (unsigned char*)out;
+    unsigned char  iv[SEALIV] = { 0 };
+    int            done;
+    memcpy(o, in, SEALAAD);
+    ((FrameHeader*)o)->flags |= FRAME_SEAL;
+    memcpy(o + SEALAAD, &session, sizeof(session));
+    memcpy(o + SEALAAD + sizeof(session), &sealed, sizeof(sealed));
+    memcpy(iv + SEALIV - sizeof(sealed), &sealed, sizeof(sealed));
+    ++sealed;
+    unsigned char *body = o + SEALAAD + SEALNONCE;
+    EVP_EncryptInit_ex(enc, NULL, NULL, NULL, iv);
+    EVP_EncryptUpdate(enc, NULL, &done, o, SEALAAD);
+    EVP_EncryptUpdate(enc, body, &done, (const unsigned char*)in + SEALAAD,
+                      length - SEALAAD);
+    EVP_EncryptFinal_ex(enc, body + done, &done);
+    EVP_CIPHER_CTX_ctrl(enc, EVP_CTRL_AEAD_GET_TAG, SEALTAG,
+                        body + length - SEALAAD);
+    return length + SEALOVERHEAD;
+} // end seal(const char[], int, char[])
+
+
+/**
+ * Authenticates and decrypts a sealed datagram. One whose session id the
+ *  opener has not seen is tried under a key derived for it, and takes a
+ *  slot among the peer sessions only if it authenticates, so a forgery
+ *  cannot unkey a session in progress; every session keeps its own replay
+ *  window, so switching between them never reopens a count.
+ * @param  in  datagram of length bytes as received.
+ * @param  out  container of at least length - SEALOVERHEAD bytes.
+ * @return Bytes of the datagram as it was before sealing, or -1 if it is
+ *          not sealed, fails authentication or is a replay.
+ */
+int Sealer::open(const char in[], int length, char out[]) {
+    const unsigned char *i = (const unsigned char*)in;
+    int                  size = length - SEALOVERHEAD;
+    uint64_t             id, count;
+    if (size < SEALAAD || !(((const FrameHeader*)i)->flags & FRAME_SEAL)) {
+        return -1;
+    } // end if (size < SEALAAD...)
+    memcpy(&id, i + SEALAAD, sizeof(id));
+    memcpy(&count, i + SEALAAD + sizeof(id), sizeof(count));
+    SealSession *peer = NULL;
+    for (int s = 0; s < SEALSESSIONS && peer == NULL; ++s) {
+        if (peers[s].used && peers[s].id == id) {
+            peer = &peers[s];
+        } // end if (peers[s].used...)
+    } // end for (; s < SEALSESSIONS...)
+    if (peer != NULL) {
+        if (decrypt(peer->ctx, i, size, out) < 0) {
+            return -1;                      // forged or corrupted
+        } // end if (decrypt(peer->ctx, i, size, out) < 0)
+    } else if ((peer = adopt(id, i, size, out)) == NULL) {
+        return -1;                          // forged, or a retired session's
+    } // end if (peer != NULL)
+    peer->last = ++opens;
+    if (!fresh(*peer, count)) {
+        ++replayed;
+        return -1;
+    } // end if (!fresh(*peer, count))
+    memcpy(out, i, SEALAAD);
+    ((FrameHeader*)out)->flags &= ~FRAME_SEAL;
+    return size;
+} // end open(const char[], int, char[])
+
+
+/**
+ * Tries a datagram of a session id not among peers[] under a key derived
+ *  for it, and on success gives that session the slot opened longest ago,
+ *  retiring the id that held it. The derivation is skipped for an id
+ *  already retired, reused while the same id is tried again, and done at
+ *  most once per SEALDERIVEGAP usec otherwise, so a flood of forged ids
+ *  costs little more than a flood of forged frames.
+ * @return The new session, or NULL if the datagram was not opened.
+ */
+SealSession *Sealer::adopt(uint64_t id, const unsigned char in[], int size,
+                           char out[]) {
+    if (isRetired(id)) {
+        return NULL;
+    } // end if (isRetired(id))
+    if (!keyed || tried != id) {
+        long now = TimerClock::now();
+        if (keyed && now - derived < SEALDERIVEGAP) {
+            return NULL;                    // the peer will send again
+        } // end if (keyed...)
+        derive(trial, id, role == INITIATOR ? RESPONDER : INITIATOR, false);
+        tried   = id;
+        keyed   = true;
+        derived = now;
+    } // end if (!keyed || tried != id)
+    if (decrypt(trial, in, size, out) < 0) {
+        return NULL;
+    } // end if (decrypt(trial, in, size, out) < 0)
+    SealSession *peer = &peers[0];
+    for (int s = 1; s < SEALSESSIONS; ++s) {
+        if (!peers[s].used || (peer->used && peers[s].last < peer->last)) {
+            peer = &peers[s];
+        } // end if (!peers[s].used...)
+    } // end for (; s < SEALSESSIONS; )
+    if (peer->used) {
+        retired[retiring] = peer->id;
+        retiring = (retiring + 1) % SEALRETIRED;
+    } // end if (peer->used)
+    EVP_CIPHER_CTX *swap = peer->ctx;
+    peer->ctx     = trial;
+    trial         = swap;
+    keyed         = false;
+    peer->id      = id;
+    peer->used    = true;
+    peer->highest = 0;
+    peer->seen    = 0;
+    return peer;
+} // end adopt(uint64_t, const unsigned char[], int, char[])
+
+
+/**
+ * @return true if id held a slot of peers[] and was pushed out of it.
+ */
+bool Sealer::isRetired(uint64_t id) const {
+    for (int r = 0; r < SEALRETIRED; ++r) {
+        if (retired[r] == id && id != 0) {
+            return true;
+        } // end if (retired[r] == id...)
+    } // end for (; r < SEALRETIRED; )
+    return false;
+} // end isRetired(uint64_t)
+
+
+/**
+ * Keys ctx for the direction that the end in role from seals in, in the
+ *  session with id session: HKDF-SHA256 of the shared secret, salted with
+ *  the id and labelled with the role.
+ */
+void Sealer::derive(EVP_CIPHER_CTX *ctx, uint64_t session, SealRole from,
+                    bool encrypt) {
+    unsigned char key[SEALKEY];
+    size_t        bytes = SEALKEY;
+    EVP_PKEY_CTX *kdf   = EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, NULL);
+    if (kdf == NULL || EVP_PKEY_derive_init(kdf) <= 0 ||
+        EVP_PKEY_CTX_set_hkdf_md(kdf, EVP_sha256()) <= 0 ||
+        EVP_PKEY_CTX_set1_hkdf_salt(kdf, (unsigned char*)&session,
+                                    sizeof(session)) <= 0 ||
+        EVP_PKEY_CTX_set1_hkdf_key(kdf, secret, SEALKEY) <= 0 ||
+        EVP_PKEY_CTX_add1_hkdf_info(kdf, (unsigned char*)sealLabel[from],
+                                    strlen(sealLabel[from])) <= 0 ||
+        EVP_PKEY_derive(kdf, key, &bytes) <= 0) {
+        cerr << "Cannot derive a session key." << endl;
+    } // end if (kdf == NULL...)
+    EVP_PKEY_CTX_free(kdf);
+    if (encrypt) {
+        EVP_EncryptInit_ex(ctx, aead, NULL, key, NULL);
+    } else {
+        EVP_DecryptInit_ex(ctx, aead, NULL, key, NULL);
+    } // end if (encrypt)
+    OPENSSL_cleanse(key, SEALKEY);
+} // end derive(EVP_CIPHER_CTX*, uint64_t, SealRole, bool)
+
+
+/**
+ * Decrypts the sealed datagram of size bytes plus SEALOVERHEAD in in[]
+ *  under ctx into out[], all but its header.
+ * @return 0, or -1 if it fails authentication.
+ */
+int Sealer::decrypt(EVP_CIPHER_CTX *ctx, const unsigned char in[], int size,
+                    char out[]) {
+    const unsigned char *count = in + SEALAAD + sizeof(uint64_t);
+    const unsigned char *body  = in + SEALAAD + SEALNONCE;
+    unsigned char        iv[SEALIV] = { 0 };
+    int                  done;
+    memcpy(iv + SEALIV - sizeof(uint64_t), count, sizeof(uint64_t));
+    EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, iv);
+    EVP_DecryptUpdate(ctx, NULL, &done, in, SEALAAD);
+    EVP_DecryptUpdate(ctx, (unsigned char*)out + SEALAAD, &done, body,
+                      size - SEALAAD);
+    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, SEALTAG,
+                        (void*)(body + size - SEALAAD));
+    return EVP_DecryptFinal_ex(ctx, (unsigned char*)out + size, &done) > 0
+           ? 0 : -1;
+} // end decrypt(EVP_CIPHER_CTX*, const unsigned char[], int, char[])
+
+
+/**
+ * Marks count opened in the peer's session.
+ * @return false if it was opened before or is more than SEALREPLAY behind
+ *          the highest count opened, too old to tell.
+ */
+bool Sealer::fresh(SealSession &peer, uint64_t count) {
+    if (count > peer.highest) {
+        uint64_t shift = count - peer.highest;
+        peer.seen    = shift >= SEALREPLAY ? 0 : peer.seen << shift;
+        peer.seen   |= 1;
+        peer.highest = count;
+        return true;
+    } // end if (count > peer.highest)
+    uint64_t behind = peer.highest - count;
+    if (behind >= SEALREPLAY || (peer.seen & ((uint64_t)1 << behind))) {
+        return false;
+    } // end if (behind >= SEALREPLAY...)
+    peer.seen |= (uint64_t)1 << behind;
+    return true;
+} // end fresh(SealSession&, uint64_t)
@@ -0,0 +1,203 @@
+/*
+ * @file   Seal.h
+ * @brief  Declares AEAD protection of frames and acks with AES-256-GCM or
+ *          ChaCha20-Poly1305 through OpenSSL, which picks the AES-NI/PCLMUL
+ *          or vector code paths the CPU supports. A sealed datagram keeps
+ *          its FrameHeader or AckHeader in the clear, with FRAME_SEAL set,
+ *          as associated data; then come the sender's session id, a count
+ *          of datagrams it has sealed, the encrypted payload and the tag.
+ *          The shared secret never keys the cipher itself: each Sealer
+ *          draws a random 64-bit session id and seals under a key derived
+ *          by HKDF from the secret, that id and a label for its role, so
+ *          every session and each direction of it has a key of its own and
+ *          the count alone, restarting at 0, is a nonce that never repeats
+ *          under it. The opener derives the peer's key from the id the
+ *          first authentic datagram of its session carries, and drops any
+ *          count it has already opened or that has fallen more than
+ *          SEALREPLAY behind the highest, as IPsec does against replays.
+ *          It keeps that window for each of the last SEALSESSIONS ids it
+ *          opened, so a datagram recorded from another session, which the
+ *          static secret still authenticates, cannot reset the window of
+ *          the one in progress; an id pushed out of that table is retired
+ *          and never opened again. An unknown id costs a key derivation
+ *          before it can be authenticated, so those are done at most once
+ *          per SEALDERIVEGAP usec and the last one tried is kept.
+ *          Each cipher context is keyed once per session and only re-IV'd
+ *          per datagram, so a window of frames costs one key schedule.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _SEAL_H_
+#define _SEAL_H_
+
+#include <stdint.h>
+
+#include "Engine.h"       // for the headers and ACKBATCH
+
+#define SEALKEY    32       // bytes of a key, for either cipher
+#define SEALNONCE  16       // bytes of session id and count sent with each
+#define SEALTAG    16       // bytes of the authentication tag
+#define SEALREPLAY 64       // counts behind the highest still accepted
+#define SEALSESSIONS 4      // peer sessions whose replay window is kept
+#define SEALRETIRED 64      // ids pushed out of those, refused from then on
+#define SEALDERIVEGAP 1000  // usec between derivations for unknown ids
+
+// bytes a sealed datagram adds, and the largest payload that still fits
+#define SEALOVERHEAD ( SEALNONCE + SEALTAG )
+#define SEALPAYLOAD ( PAYLOADSIZE - SEALOVERHEAD )
+
+typedef struct evp_cipher_st EVP_CIPHER;
+typedef struct evp_cipher_ctx_st EVP_CIPHER_CTX;
+
+enum SealCipher { AESGCM, CHACHAPOLY };
+
+// which end of a session a Sealer is; the two ends must differ
+enum SealRole { INITIATOR, RESPONDER };
+
+/**
+ * A peer session an opener has authenticated, with its replay window.
+ */
+struct SealSession {
+    uint64_t        id;         // the peer's session id
+    EVP_CIPHER_CTX *ctx;        // keyed for it
+    bool            used;       // whether this slot holds a session
+    uint64_t        highest;    // highest count opened in it
+    uint64_t        seen;       // bit i: count highest - i was opened
+    uint64_t        last;       // opens by this Sealer when it last opened
+};
+
+class Sealer {
+ public:
+    Sealer(const unsigned char key[SEALKEY], SealRole role,
+           SealCipher cipher = AESGCM);
+    ~Sealer();
+    int seal(const char in[], int length, char out[]);
+    int open(const char in[], int length, char out[]);
+    int replays() const { return replayed; }
+
+ private:
+    void derive(EVP_CIPHER_CTX *ctx, uint64_t session, SealRole from,
+                bool encrypt);
+    int  decrypt(EVP_CIPHER_CTX *ctx, const unsigned char in[], int size,
+                 char out[]);
+    SealSession *adopt(uint64_t id, const unsigned char in[], int size,
+                       char out[]);
+    bool isRetired(uint64_t id) const;
+    static bool fresh(SealSession &peer, uint64_t count);
+
+    unsigned char     secret[SEALKEY]; // shared with the peer; keys nothing
+    const EVP_CIPHER *aead;     // the cipher both ends use
+    SealRole          role;     // this end; the peer is the other
+    EVP_CIPHER_CTX   *enc;      // keyed for this end's session
+    EVP_CIPHER_CTX   *trial;    // keyed for a session id not yet proven
+    uint64_t          session;  // this end's random session id
+    uint64_t          sealed;   // datagrams sealed, the nonce of the next
+    SealSession       peers[SEALSESSIONS];  // peer sessions opened lately
+    uint64_t          retired[SEALRETIRED]; // ids pushed out of peers[]
+    int               retiring; // slot of retired[] the next one takes
+    uint64_t          tried;    // id trial is keyed for
+    bool              keyed;    // whether trial is keyed for tried
+    long              derived;  // when trial was last keyed, in usec
+    uint64_t          opens;    // datagrams opened, to age peers[]
+    int               replayed; // authentic datagrams dropped as replays
+};
+
+
+/**
+ * A transport that wraps another and seals every datagram it sends and
+ *  opens every one it receives, dropping any that fail authentication.
+ */
+template <class Transport>
+class SealSocket {
+ public:
+    /**
+     * @param  sock  transport that carries the sealed datagrams.
+     * @param  key  secret shared with the peer.
+     * @param  role  this end of the session; the peer takes the other.
+     * @param  cipher  AEAD to use; the peer must use the same.
+     */
+    SealSocket(Transport &sock, const unsigned char key[SEALKEY],
+               SealRole role, SealCipher cipher = AESGCM)
+        : sock(sock), sealer(key, role, cipher), rejected(0) { }
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+
+    /**
+     * Seals and sends a frame.
+     * @return length, or -1 if its payload is over SEALPAYLOAD bytes and
+     *          it would not fit in a datagram once sealed.
+     */
+    int sendTo(char frame[], int length) {
+        char out[MSGSIZE];
+        if (length > SEALPAYLOAD + (int)sizeof(FrameHeader)) {
+            return -1;
+        } // end if (length > SEALPAYLOAD + sizeof(FrameHeader))
+        sock.sendTo(out, sealer.seal(frame, length, out));
+        return length;
+    } // end sendTo(char[], int)
+
+    /**
+     * Seals and sends an ack.
+     * @return length, or -1 if it would not fit once sealed.
+     */
+    int ackTo(char msg[], int length) {
+        char out[MSGSIZE];
+        if (length > SEALPAYLOAD + (int)sizeof(FrameHeader)) {
+            return -1;
+        } // end if (length > SEALPAYLOAD + sizeof(FrameHeader))
+        sock.ackTo(out, sealer.seal(msg, length, out));
+        return length;
+    } // end ackTo(char[], int)
+
+    /**
+     * Receives and opens a datagram.
+     * @return Bytes of the datagram as it was sealed, or -1 if it failed
+     *          authentication.
+     */
+    int recvFrom(char msg[], int length) {
+        char in[MSGSIZE], opened[MSGSIZE];
+        int  size = check(sealer.open(in, sock.recvFrom(in, MSGSIZE), opened),
+                          length);
+        if (size > 0) {
+            memcpy(msg, opened, size);
+        } // end if (size > 0)
+        return size;
+    } // end recvFrom(char[], int)
+
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        static thread_local char in[ACKBATCH * MSGSIZE];
+        int received = sock.recvBatch(in, MSGSIZE, sizes,
+                                      count < ACKBATCH ? count : ACKBATCH);
+        for (int i = 0; i < received; ++i) {
+            char opened[MSGSIZE];
+            sizes[i] = check(sealer.open(in + i * MSGSIZE, sizes[i], opened),
+                             length);
+            if (sizes[i] > 0) {
+                memcpy(msgs + i * length, opened, sizes[i]);
+            } // end if (sizes[i] > 0)
+        } // end for (; i < received; )
+        return received;
+    } // end recvBatch(char[], int, int[], int)
+
+    /**
+     * @return Datagrams dropped for failing authentication or replaying
+     *          one already opened.
+     */
+    int forgeries() const { return rejected; }
+
+ private:
+    int check(int opened, int length) {
+        if (opened < 0 || opened > length) {
+            ++rejected;
+            return -1;
+        } // end if (opened < 0...)
+        return opened;
+    } // end check(int, int)
+
+    Transport &sock;        // carries the sealed datagrams
+    Sealer     sealer;      // keyed cipher contexts
+    int        rejected;    // datagrams that failed to open
+};
+
+#endif
@@ -0,0 +1,67 @@
+/*
+ * @file   SeqSpace.h
+ * @brief  Declares a sequence space for the sliding window protocols. Frame
+ *          sequence numbers are free-running 32-bit serial numbers compared
+ *          with RFC 1982 style arithmetic, and buffered frames are kept in a
+ *          ring whose size is a power of two so that a sequence number maps
+ *          to its slot with a single mask instead of an integer division.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _SEQSPACE_H_
+#define _SEQSPACE_H_
+
+#include <stdint.h>
+
+class SeqSpace {
+ public:
+    /**
+     * Builds a ring that can hold at least windowSize frames.
+     * @param  windowSize  number of frames that may be in transit at once.
+     * @pre    windowSize > 0.
+     * @post   size() is the smallest power of two >= windowSize.
+     */
+    explicit SeqSpace(int windowSize) : ringSize(1) {
+        while (ringSize < windowSize) {
+            ringSize <<= 1;
+        } // end while(ringSize < windowSize)
+        mask = ringSize - 1;
+    } // end SeqSpace(int)
+
+    /**
+     * @return Number of slots in the ring; always a power of two.
+     */
+    int size() const { return ringSize; }
+
+    /**
+     * @param  seq  any sequence number.
+     * @return The ring slot that buffers frame seq.
+     */
+    int slot(uint32_t seq) const { return (int)(seq & mask); }
+
+    /**
+     * Serial number distance from b to a. Valid as long as the two numbers
+     *  are less than 2^31 apart, which any sane window guarantees.
+     * @return a - b as a signed quantity.
+     */
+    static int32_t diff(uint32_t a, uint32_t b) { return (int32_t)(a - b); }
+
+    /**
+     * @return true if a precedes b in serial number order.
+     */
+    static bool before(uint32_t a, uint32_t b) { return diff(a, b) < 0; }
+
+    /**
+     * @return true if seq lies in the half-open window [base, base + width).
+     */
+    static bool inWindow(uint32_t seq, uint32_t base, uint32_t width) {
+        return seq - base < width;
+    } // end inWindow(uint32_t, uint32_t, uint32_t)
+
+ private:
+    int      ringSize;  // number of slots, a power of two
+    uint32_t mask;      // ringSize - 1
+};
+
+#endif
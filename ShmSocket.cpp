@@ -0,0 +1,323 @@
+/*
+ * @file   ShmSocket.cpp
+ * @brief  Implements the shared-memory transport declared in ShmSocket.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "ShmSocket.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+static const int  ATTACH_TRIES = 1000;    // attempts to reach the owner, 10 s
+static const long FUTEX_NSEC   = 10000000; // longest sleep between checks
+
+static long futex(std::atomic<uint32_t> *word, int op, uint32_t val,
+                  const struct timespec *timeout) {
+    return syscall(SYS_futex, (uint32_t*)word, op, val, timeout, NULL, 0);
+} // end futex(std::atomic<uint32_t>*, int, uint32_t, const timespec*)
+
+
+/**
+ * As the owner, creates the shared segment and offers it on a rendezvous
+ *  socket named after port; otherwise does nothing until setDestAddress()
+ *  attaches to the owner's. Roles are fixed rather than settled by which
+ *  side starts first, so a side can never attach to its own segment.
+ * @param  port  port number both sides agree on.
+ * @param  owner  true on the side that creates the segment, the server.
+ */
+ShmSocket::ShmSocket(int port, bool owner)
+    : port(port), listener(NULL_SD), memfd(NULL_SD), segment(NULL),
+      in(NULL), out(NULL) {
+    if (!owner) {
+        return;
+    } // end if (!owner)
+    struct sockaddr_un addr;
+    socklen_t addrLen;
+    name(addr, addrLen);
+    listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (listener < 0 || bind(listener, (sockaddr*)&addr, addrLen) < 0 ||
+        listen(listener, 1) < 0) {
+        cerr << "Cannot offer shared memory on port " << port << endl;
+        if (listener >= 0) {
+            close(listener);
+        } // end if (listener >= 0)
+        listener = NULL_SD;             // another owner holds this port
+        return;
+    } // end if (listener < 0...)
+    int fd = memfd_create("css432-shm", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, 2 * sizeof(ShmRing)) < 0 || !mapSegment(fd)) {
+        cerr << "Cannot create the shared memory segment." << endl;
+        return;
+    } // end if (fd < 0...)
+    // the owner receives on ring 0 and sends on ring 1
+    in  = &segment[0];
+    out = &segment[1];
+} // end ShmSocket(int)
+
+
+ShmSocket::~ShmSocket() {
+    if (segment != NULL) {
+        munmap(segment, 2 * sizeof(ShmRing));
+    } // end if (segment != NULL)
+    if (memfd != NULL_SD) {
+        close(memfd);
+    } // end if (memfd != NULL_SD)
+    if (listener != NULL_SD) {
+        close(listener);
+    } // end if (listener != NULL_SD)
+} // end ~ShmSocket()
+
+
+/**
+ * Attaches to the segment offered by the owner on this host. The peer is
+ *  always local, so ipName is not consulted.
+ * @param  ipName  name of the peer host, expected to be this one.
+ * @return true if the segment was received and mapped; false on the owner,
+ *          which has its own segment and must not attach to it.
+ */
+bool ShmSocket::setDestAddress(char ipName[]) {
+    if (segment != NULL || listener != NULL_SD) {
+        cerr << "The shared memory owner cannot attach to a peer." << endl;
+        return false;
+    } // end if (segment != NULL...)
+    struct sockaddr_un addr;
+    socklen_t addrLen;
+    name(addr, addrLen);
+    int sd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sd < 0) {
+        cerr << "Cannot open a socket to the shared memory peer." << endl;
+        return false;
+    } // end if (sd < 0)
+    // give a peer that starts at the same moment time to appear
+    int tries = 0;
+    while (connect(sd, (sockaddr*)&addr, addrLen) < 0) {
+        if (++tries == ATTACH_TRIES) {
+            cerr << "Cannot find a shared memory peer for " << ipName << endl;
+            close(sd);
+            return false;
+        } // end if (++tries == ATTACH_TRIES)
+        usleep(10000);
+    } // end while(connect(sd...) < 0)
+
+    // receive the memfd as ancillary data
+    char byte;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { &byte, 1 };
+    struct msghdr msg;
+    bzero((char*)&msg, sizeof(msg));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    int received = recvmsg(sd, &msg, 0);
+    close(sd);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (received < 1 || cmsg == NULL || cmsg->cmsg_type != SCM_RIGHTS) {
+        cerr << "Cannot receive the shared memory segment." << endl;
+        return false;
+    } // end if (received < 1...)
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
+    if (!mapSegment(fd)) {
+        return false;
+    } // end if (!mapSegment(fd))
+    // the attaching side sends on ring 0 and receives on ring 1
+    in  = &segment[1];
+    out = &segment[0];
+    return true;
+} // end setDestAddress(char[])
+
+
+/**
+ * Checks for a waiting datagram, sleeping on the ring's futex for up to
+ *  usec if there is none, as UdpSocket::pollRecvFrom() sleeps in ppoll(),
+ *  so a receiver holding back an ack does not spin against its peer.
+ * @param  usec  longest wait; 0 or less checks once without sleeping.
+ * @return 1 if a datagram is waiting, 0 otherwise.
+ */
+int ShmSocket::pollRecvFrom(long usec) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long deadline = now.tv_sec * 1000000000L + now.tv_nsec + usec * 1000;
+    while (!waiting()) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long left = deadline - (now.tv_sec * 1000000000L + now.tv_nsec);
+        if (left <= 0) {
+            return 0;
+        } // end if (left <= 0)
+        nap(left < FUTEX_NSEC ? left : FUTEX_NSEC);
+    } // end while(!waiting())
+    return 1;
+} // end pollRecvFrom(long)
+
+
+/**
+ * Copies msg[] into the next free slot of the outgoing ring and wakes the
+ *  peer if it sleeps.
+ * @return length, or -1 if the ring is full and the datagram was dropped.
+ */
+int ShmSocket::sendTo(char msg[], int length) {
+    if (out == NULL || length > MSGSIZE) {
+        return -1;
+    } // end if (out == NULL...)
+    uint32_t tail = out->tail.load(std::memory_order_relaxed);
+    if (tail - out->head.load(std::memory_order_acquire) == SHMSLOTS) {
+        errno = ENOBUFS;
+        return -1;                      // full: drop it, as UDP would
+    } // end if (tail - out->head...)
+    int slot = tail & (SHMSLOTS - 1);
+    memcpy(out->data[slot], msg, length);
+    out->lengths[slot] = length;
+    out->tail.store(tail + 1, std::memory_order_release);
+    if (out->sleepers.load(std::memory_order_seq_cst) > 0) {
+        futex(&out->tail, FUTEX_WAKE, 1, NULL);
+    } // end if (out->sleepers...)
+    return length;
+} // end sendTo(char[], int)
+
+
+/**
+ * Blocks until a datagram is waiting, then copies it into msg[].
+ * @return Bytes received, truncated to length.
+ */
+int ShmSocket::recvFrom(char msg[], int length) {
+    while (!waiting()) {
+        nap(FUTEX_NSEC);                // wake now and then to accept a peer
+    } // end while(!waiting())
+    int sizes[1];
+    recvBatch(msg, length, sizes, 1);
+    return sizes[0];
+} // end recvFrom(char[], int)
+
+
+/**
+ * Copies up to count waiting datagrams without blocking into consecutive
+ *  length-byte slots of msgs[], storing each size in sizes[].
+ * @return Number of datagrams received, 0 if none were waiting.
+ */
+int ShmSocket::recvBatch(char msgs[], int length, int sizes[], int count) {
+    if (!waiting()) {
+        return 0;
+    } // end if (!waiting())
+    uint32_t head = in->head.load(std::memory_order_relaxed);
+    uint32_t tail = in->tail.load(std::memory_order_acquire);
+    int received = 0;
+    for (; head != tail && received < count; ++head, ++received) {
+        int slot = head & (SHMSLOTS - 1);
+        sizes[received] = in->lengths[slot] < length ? in->lengths[slot]
+                                                     : length;
+        memcpy(msgs + received * length, in->data[slot], sizes[received]);
+    } // end for (; head != tail...)
+    in->head.store(head, std::memory_order_release);
+    return received;
+} // end recvBatch(char[], int, int[], int)
+
+
+/**
+ * Acks travel the same outgoing ring as data; there is only one peer.
+ */
+int ShmSocket::ackTo(char msg[], int length) {
+    return sendTo(msg, length);
+} // end ackTo(char[], int)
+
+
+/**
+ * Hands the segment to a peer if one is waiting for it.
+ * @return true if a datagram is waiting to be read.
+ */
+bool ShmSocket::waiting() {
+    acceptPeer();
+    return in != NULL && in->head.load(std::memory_order_relaxed) !=
+                         in->tail.load(std::memory_order_acquire);
+} // end waiting()
+
+
+/**
+ * Sleeps for up to nsec, or until the peer writes into the incoming ring
+ *  if this side is attached.
+ */
+void ShmSocket::nap(long nsec) {
+    struct timespec timeout = { nsec / 1000000000L, nsec % 1000000000L };
+    if (in == NULL) {
+        nanosleep(&timeout, NULL);      // not attached yet
+        return;
+    } // end if (in == NULL)
+    uint32_t tail = in->tail.load(std::memory_order_acquire);
+    in->sleepers.fetch_add(1, std::memory_order_seq_cst);
+    if (in->head.load(std::memory_order_relaxed) == tail) {
+        futex(&in->tail, FUTEX_WAIT, tail, &timeout);   // until tail moves
+    } // end if (in->head... == tail)
+    in->sleepers.fetch_sub(1, std::memory_order_relaxed);
+} // end nap(long)
+
+
+/**
+ * Maps the two rings of the segment in fd.
+ */
+bool ShmSocket::mapSegment(int fd) {
+    void *base = mmap(NULL, 2 * sizeof(ShmRing), PROT_READ | PROT_WRITE,
+                      MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        cerr << "Cannot map the shared memory segment." << endl;
+        close(fd);
+        return false;
+    } // end if (base == MAP_FAILED)
+    memfd   = fd;
+    segment = (ShmRing*)base;
+    return true;
+} // end mapSegment(int)
+
+
+/**
+ * Hands the segment descriptor to a peer waiting on the rendezvous socket,
+ *  if there is one, and stops listening once it has. Only the owner
+ *  listens.
+ */
+void ShmSocket::acceptPeer() {
+    if (listener == NULL_SD || memfd == NULL_SD) {
+        return;
+    } // end if (listener == NULL_SD...)
+    int peer = accept(listener, NULL, NULL);
+    if (peer < 0) {
+        return;                         // nobody waiting
+    } // end if (peer < 0)
+    char byte = 0;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { &byte, 1 };
+    struct msghdr msg;
+    bzero((char*)&msg, sizeof(msg));
+    bzero(control, sizeof(control));
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &memfd, sizeof(memfd));
+    if (sendmsg(peer, &msg, 0) > 0) {
+        close(listener);                // sessions are point-to-point
+        listener = NULL_SD;
+    } // end if (sendmsg(peer, &msg, 0) > 0)
+    close(peer);
+} // end acceptPeer()
+
+
+/**
+ * Fills addr with the abstract unix socket name for this port.
+ */
+void ShmSocket::name(struct sockaddr_un &addr, socklen_t &addrLen) const {
+    bzero((char*)&addr, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    // a leading NUL puts the name in the abstract namespace
+    int length = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1,
+                          "css432-shm-%d", port);
+    addrLen = offsetof(struct sockaddr_un, sun_path) + 1 + length;
+} // end name(struct sockaddr_un&, socklen_t&) const
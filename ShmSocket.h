@@ -0,0 +1,67 @@
+/*
+ * @file   ShmSocket.h
+ * @brief  Declares a transport with the interface of UdpSocket that moves
+ *          datagrams between two processes on the same host through a pair
+ *          of rings in a shared memfd segment, so the protocol engines run
+ *          unchanged without crossing the network stack. The side built
+ *          as the owner, the server, creates the segment and hands its
+ *          descriptor over a unix domain socket to the other side, which
+ *          attaches in setDestAddress(); a reader with nothing to read
+ *          sleeps on a futex in the segment.
+ *          Like UDP, a datagram sent into a full ring is dropped.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _SHMSOCKET_H_
+#define _SHMSOCKET_H_
+
+#include <atomic>
+#include <stdint.h>
+#include <sys/un.h>
+
+#include "UdpSocket.h"      // for MSGSIZE and NULL_SD
+
+#define SHMSLOTS 256        // datagrams each ring can hold, a power of two
+
+/**
+ * Single-producer, single-consumer ring of datagrams. tail doubles as the
+ *  futex word a sleeping consumer waits on.
+ */
+struct ShmRing {
+    std::atomic<uint32_t> head;         // next slot to read
+    char                  pad1[60];     // keep head and tail on own lines
+    std::atomic<uint32_t> tail;         // next slot to write
+    std::atomic<uint32_t> sleepers;     // consumers waiting on tail
+    char                  pad2[56];
+    int32_t               lengths[SHMSLOTS];
+    char                  data[SHMSLOTS][MSGSIZE];
+};
+
+class ShmSocket {
+ public:
+    ShmSocket(int port, bool owner);
+    ~ShmSocket();
+    bool setDestAddress(char ipName[]);
+    int  pollRecvFrom(long usec = 0);
+    int  sendTo(char msg[], int length);
+    int  recvFrom(char msg[], int length);
+    int  recvBatch(char msgs[], int length, int sizes[], int count);
+    int  ackTo(char msg[], int length);
+
+ private:
+    bool waiting();
+    void nap(long nsec);
+    bool mapSegment(int fd);
+    void acceptPeer();
+    void name(struct sockaddr_un &addr, socklen_t &addrLen) const;
+
+    int      port;          // names the rendezvous socket
+    int      listener;      // unix socket the owner hands the memfd out on
+    int      memfd;         // shared segment descriptor
+    ShmRing *segment;       // the two rings, NULL until attached
+    ShmRing *in;            // ring this side reads
+    ShmRing *out;           // ring this side writes
+};
+
+#endif
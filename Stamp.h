@@ -0,0 +1,234 @@
+/*
+ * @file   Stamp.h
+ * @brief  Declares one-way delay measurement by timestamp echo, as NTP
+ *          does it. A StampSocket at the sender puts its clock's time in
+ *          every frame it sends; one at the receiver notes when each frame
+ *          arrives and echoes that frame's stamp in the next ack it sends,
+ *          with its own clock's times for when the frame came in and when
+ *          the ack left. Back at the sender the four times split the round
+ *          trip into its forward and reverse legs, less however long the
+ *          receiver held the ack. Each leg is off by the difference between
+ *          the clocks, equal and opposite; assuming the two legs' least
+ *          delays match, half the difference of their minima is the offset.
+ *          How the least forward delay drifts over a transfer is how fast
+ *          one clock runs against the other: the skew.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _STAMP_H_
+#define _STAMP_H_
+
+#include <string.h>
+
+#include "Engine.h"
+
+static const int SKEWSPAN = 256;    // delay samples per skew point
+
+// bytes a StampHeader and an EchoHeader add to the header they extend
+#define STAMPBYTES ( (int)sizeof( StampHeader ) - (int)sizeof( FrameHeader ) )
+#define ECHOBYTES ( (int)sizeof( EchoHeader ) - (int)sizeof( AckHeader ) )
+
+/**
+ * Gathers the forward and reverse delay of every echoed stamp and fits a
+ *  line through the least forward delay of each SKEWSPAN of them.
+ */
+class OwdEstimator {
+ public:
+    OwdEstimator()
+        : count(0), fwdSum(0), revSum(0), fwdMin(0), revMin(0), start(0),
+          spanMin(0), spanAt(0), points(0), sx(0), sy(0), sxx(0), sxy(0) { }
+
+    /**
+     * Adds one echo.
+     * @param  sent  when the frame left, on the sender's clock.
+     * @param  received  when it arrived, on the receiver's clock.
+     * @param  acked  when the ack left, on the receiver's clock.
+     * @param  now  when the ack arrived, on the sender's clock.
+     */
+    void add(long sent, long received, long acked, long now) {
+        long forward = received - sent;
+        long reverse = now - acked;
+        if (count == 0) {
+            fwdMin = forward;
+            revMin = reverse;
+            start  = now;
+        } // end if (count == 0)
+        fwdMin  = forward < fwdMin ? forward : fwdMin;
+        revMin  = reverse < revMin ? reverse : revMin;
+        fwdSum += forward;
+        revSum += reverse;
+        if (count % SKEWSPAN == 0 || forward < spanMin) {
+            spanMin = forward;
+            spanAt  = sent;
+        } // end if (count % SKEWSPAN == 0...)
+        if (++count % SKEWSPAN == 0) {
+            double x = (spanAt - start) / 1e6;  // seconds into the transfer
+            ++points;
+            sx  += x;
+            sy  += spanMin;
+            sxx += x * x;
+            sxy += x * spanMin;
+        } // end if (++count % SKEWSPAN == 0)
+    } // end add(long, long, long, long)
+
+    int    samples() const { return count; }
+    double forward() const { return count ? (double)fwdSum / count : 0; }
+    double reverse() const { return count ? (double)revSum / count : 0; }
+    long   forwardMin() const { return fwdMin; }
+    long   reverseMin() const { return revMin; }
+
+    /**
+     * @return usec the receiver's clock is ahead of the sender's, taking
+     *          the least delay each way to be the same.
+     */
+    double offset() const { return (fwdMin - revMin) / 2.0; }
+
+    /**
+     * @return usec per second, or ppm, that the receiver's clock gains on
+     *          the sender's; 0 until two skew points are in.
+     */
+    double skew() const {
+        double spread = points * sxx - sx * sx;
+        return points < 2 || spread <= 0 ? 0
+                                         : (points * sxy - sx * sy) / spread;
+    } // end skew()
+
+ private:
+    int    count;           // echoes added
+    long   fwdSum;          // sum of their forward delays
+    long   revSum;          // and reverse delays
+    long   fwdMin;          // least forward delay
+    long   revMin;          // least reverse delay
+    long   start;           // when the first echo came back
+    long   spanMin;         // least forward delay of this skew span
+    long   spanAt;          // when that frame was sent
+    int    points;          // skew points fitted
+    double sx, sy;          // sums over them of seconds and least delay
+    double sxx, sxy;        // and of seconds squared and seconds by delay
+};
+
+
+/**
+ * A transport that wraps another and stamps every frame it sends and
+ *  echoes the stamps of the frames it receives, so one at each end of an
+ *  engine measures one-way delay without the engine knowing.
+ */
+template <class Transport, class Clock = TimerClock>
+class StampSocket {
+ public:
+    StampSocket(Transport &sock) : sock(sock), pending(false) { }
+
+    int pollRecvFrom(long usec = 0) { return sock.pollRecvFrom(usec); }
+
+    /**
+     * Sends a frame with the time in its header.
+     * @pre    The frame's payload is at most STAMPPAYLOAD bytes.
+     */
+    int sendTo(char frame[], int length) {
+        char    out[MSGSIZE];
+        int64_t now = Clock::now();
+        int     size = insert(frame, length, &now, STAMPBYTES, out);
+        sock.sendTo(out, size);
+        return length;
+    } // end sendTo(char[], int)
+
+    /**
+     * Sends an ack echoing the stamp of the last frame received, unless
+     *  an earlier ack has already echoed it.
+     */
+    int ackTo(char msg[], int length) {
+        if (!pending) {
+            return sock.ackTo(msg, length);
+        } // end if (!pending)
+        char    out[MSGSIZE];
+        int64_t times[3] = { echo, received, Clock::now() };
+        int     size = insert(msg, length, times, ECHOBYTES, out);
+        pending = false;
+        sock.ackTo(out, size);
+        return length;
+    } // end ackTo(char[], int)
+
+    int recvFrom(char msg[], int length) {
+        char in[MSGSIZE];
+        return strip(in, sock.recvFrom(in, MSGSIZE), msg, length);
+    } // end recvFrom(char[], int)
+
+    int recvBatch(char msgs[], int length, int sizes[], int count) {
+        static thread_local char in[ACKBATCH * MSGSIZE];
+        int received = sock.recvBatch(in, MSGSIZE, sizes,
+                                      count < ACKBATCH ? count : ACKBATCH);
+        for (int i = 0; i < received; ++i) {
+            sizes[i] = strip(in + i * MSGSIZE, sizes[i], msgs + i * length,
+                             length);
+        } // end for (; i < received; )
+        return received;
+    } // end recvBatch(char[], int, int[], int)
+
+    const OwdEstimator &delays() const { return owd; }
+
+ private:
+    /**
+     * Copies msg[] to out[] with bytes of times after its flags word.
+     * @return Bytes of out[].
+     */
+    static int insert(const char msg[], int length, const void *times,
+                      int bytes, char out[]) {
+        memcpy(out, msg, sizeof(FrameHeader));
+        ((FrameHeader*)out)->flags |= FRAME_STAMP;
+        memcpy(out + sizeof(FrameHeader), times, bytes);
+        memcpy(out + sizeof(FrameHeader) + bytes, msg + sizeof(FrameHeader),
+               length - sizeof(FrameHeader));
+        return length + bytes;
+    } // end insert(const char[], int, const void*, int, char[])
+
+    /**
+     * Takes the stamp or echo out of a datagram of size bytes in in[],
+     *  noting a frame's stamp for the next ack and adding an ack's echo to
+     *  the estimate, and copies what is left to msg[].
+     * @return Bytes now in msg[].
+     */
+    int strip(const char in[], int size, char msg[], int length) {
+        const FrameHeader *header = (const FrameHeader*)in;
+        int                bytes  = 0;
+        if (size >= (int)sizeof(FrameHeader) &&
+            (header->flags & FRAME_STAMP)) {
+            bool isAck = header->flags & (FRAME_ACK | FRAME_NACK);
+            bytes = isAck ? ECHOBYTES : STAMPBYTES;
+            if (size < (int)sizeof(FrameHeader) + bytes) {
+                return -1;                  // runt
+            } // end if (size < sizeof(FrameHeader) + bytes)
+            int64_t times[3];
+            memcpy(times, in + sizeof(FrameHeader), bytes);
+            if (isAck) {
+                owd.add(times[0], times[1], times[2], Clock::now());
+            } else {
+                echo     = times[0];
+                received = Clock::now();
+                pending  = true;
+            } // end if (isAck)
+        } // end if (size >= sizeof(FrameHeader)...)
+        if (size < 0 || size - bytes > length) {
+            return -1;
+        } // end if (size < 0...)
+        memcpy(msg, in, size < (int)sizeof(FrameHeader) ? size
+                                                        : sizeof(FrameHeader));
+        if (size > (int)sizeof(FrameHeader)) {
+            memcpy(msg + sizeof(FrameHeader),
+                   in + sizeof(FrameHeader) + bytes,
+                   size - sizeof(FrameHeader) - bytes);
+        } // end if (size > sizeof(FrameHeader))
+        if (bytes > 0) {
+            ((FrameHeader*)msg)->flags &= ~FRAME_STAMP;
+        } // end if (bytes > 0)
+        return size - bytes;
+    } // end strip(const char[], int, char[], int)
+
+    Transport   &sock;      // carries the stamped datagrams
+    OwdEstimator owd;       // delays of the frames this end sent
+    bool         pending;   // whether a frame's stamp awaits an ack
+    int64_t      echo;      // that stamp
+    int64_t      received;  // when its frame arrived
+};
+
+#endif
@@ -0,0 +1,420 @@
+/*
+ * @file   Stream.h
+ * @brief  Declares a layer that multiplexes many ordered streams over one
+ *          connection. Every stream shares the sender's window and
+ *          congestion controller; a StreamHeader in front of each payload
+ *          names the stream and the message's place in it. The receiver
+ *          acknowledges each frame by its stream and place rather than
+ *          cumulatively, so the window is released frame by frame and a
+ *          frame lost on one stream holds back that stream alone: the
+ *          others keep the window moving while it is resent. The sender
+ *          picks which stream fills the next free place in the window by
+ *          weighted round robin over the streams with messages queued. Flow
+ *          control is per stream and lives at the sender: every ack grants
+ *          each stream the messages its reader has room for, and a stream
+ *          that has used its grant simply is not scheduled, so the receiver
+ *          never has to refuse a frame. A sender whose every stream waits
+ *          on a grant, with nothing in transit, probes for one once per
+ *          timeout, in case the ack that carried it was lost.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+#include <vector>
+
+#include "Engine.h"
+
+template <class Cc = FixedWindow, class Clock = TimerClock,
+          class Transport = UdpSocket>
+class StreamSender {
+ public:
+    /**
+     * @param  sock  bound socket with a destination set.
+     * @param  windowSize  largest number of frames in transit, all streams,
+     *                      and the receive window of each stream.
+     * @param  streams  number of streams, each starting with weight 1.
+     * @pre    windowSize > 0 and 0 < streams <= STREAMMAX.
+     */
+    StreamSender(Transport &sock, int windowSize, int streams)
+        : sock(sock), capacity(windowSize), space(windowSize),
+          streams(streams), queues(space.size() * streams * MSGSIZE),
+          lengths(space.size() * streams), sentAt(space.size() * streams),
+          acked(space.size() * streams), resent(space.size() * streams),
+          weights(streams, 1), base(streams, 0), head(streams, 0),
+          tail(streams, 0), limit(streams, windowSize), inFlight(0),
+          sent(0), probedAt(0), turn(streams - 1), credit(0), retrans(0) {
+        cc.init(capacity);                   // stream 0 takes the first turn
+    } // end StreamSender(Transport&, int, int)
+
+    /**
+     * Sets how many frames stream may send each round while the others
+     *  have messages queued.
+     * @pre    weight > 0.
+     */
+    void setWeight(int stream, int weight) { weights[stream] = weight; }
+
+    /**
+     * Queues msg[] as the next message of stream. A stream holds at most
+     *  one window of messages not yet acknowledged; pump() drains them.
+     * @param  stream  stream number, below the number of streams.
+     * @param  msg  payload to transmit.
+     * @param  length  bytes of msg[]; at most STREAMPAYLOAD.
+     * @return false if the stream's queue is full and nothing was queued.
+     */
+    bool write(int stream, const char msg[], int length) {
+        if (tail[stream] - base[stream] == (uint32_t)space.size()) {
+            return false;
+        } // end if (tail[stream] - base[stream]...)
+        int   slot = index(stream, tail[stream]);
+        char *out  = &queues[slot * MSGSIZE] + sizeof(FrameHeader);
+        ((StreamHeader*)out)->stream = stream;
+        ((StreamHeader*)out)->seq    = tail[stream]++;
+        memcpy(out + sizeof(StreamHeader), msg, length);
+        lengths[slot] = sizeof(FrameHeader) + sizeof(StreamHeader) + length;
+        return true;
+    } // end write(int, const char[], int)
+
+    /**
+     * Takes in acks, resends frames that have timed out, then fills the
+     *  window from the queues in scheduled order. Never blocks.
+     */
+    void pump() {
+        ackAdvance();
+        checkTimeout();
+        int stream;
+        while (canSend() && (stream = schedule()) >= 0) {
+            transmit(stream, head[stream]);
+            ++head[stream];
+            ++inFlight;
+        } // end while(canSend()...)
+    } // end pump()
+
+    /**
+     * Blocks until every queued message has been sent and acknowledged.
+     */
+    void flush() {
+        for (int stream = 0; stream < streams; ++stream) {
+            while (base[stream] != tail[stream]) {
+                pump();
+            } // end while(base[stream] != tail[stream])
+        } // end for (; stream < streams; )
+    } // end flush()
+
+    int queued(int stream) const { return tail[stream] - head[stream]; }
+    int retransmits() const { return retrans; }
+
+ private:
+    int index(int stream, uint32_t seq) const {
+        return stream * space.size() + space.slot(seq);
+    } // end index(int, uint32_t)
+
+    bool canSend() const {
+        return inFlight < capacity && inFlight < cc.window();
+    } // end canSend()
+
+    /**
+     * Sends message seq of stream, first or again, under the next
+     *  connection sequence number.
+     */
+    void transmit(int stream, uint32_t seq) {
+        int   slot  = index(stream, seq);
+        char *frame = &queues[slot * MSGSIZE];
+        ((FrameHeader*)frame)->seq   = sent++;
+        ((FrameHeader*)frame)->flags = 0;
+        if (SeqSpace::before(seq, head[stream])) {
+            resent[slot] = true;
+            ++retrans;
+        } else {
+            acked[slot]  = false;
+            resent[slot] = false;
+        } // end if (SeqSpace::before(seq, head[stream]))
+        sentAt[slot] = Clock::now();
+        sock.sendTo(frame, lengths[slot]);
+    } // end transmit(int, uint32_t)
+
+    /**
+     * Picks the stream to send next: the one whose turn it is keeps it for
+     *  weight frames, and a stream with nothing queued or nothing granted
+     *  passes it on.
+     * @return Stream number, or -1 if no stream may send.
+     */
+    int schedule() {
+        for (int visited = 0; visited <= streams; ++visited) {
+            if (credit > 0 && mayRun(turn)) {
+                --credit;
+                return turn;
+            } // end if (credit > 0...)
+            turn   = (turn + 1) % streams;
+            credit = weights[turn];
+        } // end for (; visited <= streams; )
+        return -1;
+    } // end schedule()
+
+    bool mayRun(int stream) const {
+        return head[stream] != tail[stream] &&
+               SeqSpace::before(head[stream], limit[stream]);
+    } // end mayRun(int)
+
+    /**
+     * Drains every ack queued on the socket. Each raises the grants it
+     *  carries and releases the one frame it names, and the controller
+     *  hears of every frame released.
+     */
+    void ackAdvance() {
+        StreamAckHeader heard[ACKBATCH];
+        int             sizes[ACKBATCH];
+        int             received;
+        long            now = Clock::now();
+        do {
+            received = sock.recvBatch((char*)heard, sizeof(StreamAckHeader),
+                                      sizes, ACKBATCH);
+            for (int i = 0; i < received; ++i) {
+                if (sizes[i] < (int)(3 + streams) * (int)sizeof(uint32_t) ||
+                    (heard[i].flags & (FRAME_ACK | FRAME_STREAM)) !=
+                        (FRAME_ACK | FRAME_STREAM)) {
+                    continue;               // runt or not for this layer
+                } // end if (sizes[i] < ...)
+                for (int s = 0; s < streams; ++s) {
+                    if (SeqSpace::before(limit[s], heard[i].limit[s])) {
+                        limit[s] = heard[i].limit[s];
+                    } // end if (SeqSpace::before(limit[s]...))
+                } // end for (; s < streams; )
+                onAck(heard[i].stream, heard[i].seq, now);
+            } // end for (; i < received; )
+        } while (received == ACKBATCH);
+    } // end ackAdvance()
+
+    /**
+     * Releases message seq of stream if it is in transit and not yet
+     *  released, and moves the stream's base past every released message.
+     */
+    void onAck(uint32_t stream, uint32_t seq, long now) {
+        if (stream >= (uint32_t)streams ||
+            !SeqSpace::inWindow(seq, base[stream],
+                                head[stream] - base[stream])) {
+            return;                         // grants only, or stale
+        } // end if (stream >= streams...)
+        int slot = index(stream, seq);
+        if (acked[slot]) {
+            return;                         // a duplicate
+        } // end if (acked[slot])
+        acked[slot] = true;
+        --inFlight;
+        AckSample sample;
+        sample.acked     = 1;
+        sample.rtt       = resent[slot] ? -1 : now - sentAt[slot];  // Karn
+        sample.marked    = 0;
+        sample.rate      = 0;
+        sample.bandwidth = 0;
+        cc.onAck(sample);
+        while (base[stream] != head[stream] &&
+               acked[index(stream, base[stream])]) {
+            ++base[stream];
+        } // end while(base[stream] != head[stream]...)
+    } // end onAck(uint32_t, uint32_t, long)
+
+    /**
+     * Resends the oldest frame in transit of each stream once it has waited
+     *  MAX_TIME for its ack, as selective repeat resends only the oldest;
+     *  a later one lost is resent when it becomes the oldest. Then probes
+     *  for grants if every stream with messages queued is held back by its
+     *  grant and nothing is in transit to draw an ack.
+     */
+    void checkTimeout() {
+        long now     = Clock::now();
+        bool expired = false;
+        bool waiting = false;
+        for (int s = 0; s < streams; ++s) {
+            if (base[s] != head[s] &&
+                now - sentAt[index(s, base[s])] > MAX_TIME) {
+                transmit(s, base[s]);       // unacked, as base always is
+                expired = true;
+            } // end if (base[s] != head[s]...)
+            waiting |= head[s] != tail[s];
+        } // end for (; s < streams; )
+        if (expired) {
+            cc.onTimeout();
+        } // end if (expired)
+        if (inFlight == 0 && waiting && now - probedAt > MAX_TIME) {
+            FrameHeader probe;
+            probe.seq   = sent;
+            probe.flags = FRAME_STREAM;
+            sock.sendTo((char*)&probe, sizeof(probe));
+            probedAt = now;
+        } // end if (inFlight == 0...)
+    } // end checkTimeout()
+
+    Transport            &sock;     // carries frames out and acks in
+    Cc                    cc;       // congestion controller for all streams
+    int                   capacity; // largest number of frames in transit
+    SeqSpace              space;    // maps stream sequences to queue slots
+    int                   streams;  // number of streams
+    std::vector<char>     queues;   // framed messages, one ring per stream
+    std::vector<int>      lengths;  // bytes of each framed message
+    std::vector<long>     sentAt;   // time each was last sent
+    std::vector<bool>     acked;    // whether each sent one was acked
+    std::vector<bool>     resent;   // whether each was sent more than once
+    std::vector<int>      weights;  // frames per round of each stream
+    std::vector<uint32_t> base;     // oldest message not acked, per stream
+    std::vector<uint32_t> head;     // next message to send, per stream
+    std::vector<uint32_t> tail;     // next free queue place, per stream
+    std::vector<uint32_t> limit;    // first message not granted, per stream
+    int                   inFlight; // frames sent and not acked
+    uint32_t              sent;     // frames sent on the connection
+    long                  probedAt; // time grants were last asked for
+    int                   turn;     // stream the scheduler is serving
+    int                   credit;   // frames left in its turn
+    int                   retrans;  // frames transmitted more than once
+};
+
+
+template <class Transport = UdpSocket>
+class StreamReceiver {
+ public:
+    /**
+     * @param  sock  bound socket frames arrive on.
+     * @param  windowSize  window of the StreamSender at the other end, and
+     *                      the messages each stream's reader has room for.
+     * @param  streams  number of streams, as the sender has.
+     * @pre    windowSize > 0 and 0 < streams <= STREAMMAX.
+     */
+    StreamReceiver(Transport &sock, int windowSize, int streams)
+        : sock(sock), capacity(windowSize), space(windowSize),
+          streams(streams), frames(space.size() * streams * MSGSIZE),
+          lengths(space.size() * streams, +EMPTY), nextDeliver(streams, 0),
+          granted(streams, windowSize), updates(0), overruns(0) { }
+
+    /**
+     * Blocks until a frame arrives, then keeps it for its stream and
+     *  acknowledges it.
+     * @return Number of messages handed to streams, 0 or 1.
+     */
+    int receive() {
+        char frame[MSGSIZE];
+        int  length = sock.recvFrom(frame, MSGSIZE);
+        return onFrame(frame, length);
+    } // end receive()
+
+    /**
+     * As receive(), for a frame the caller has already read. A message
+     *  within its stream's grant is kept if new and acked either way; one
+     *  already read is a resend whose ack was lost and is acked again.
+     */
+    int onFrame(const char frame[], int length) {
+        const FrameHeader  *frameHeader = (const FrameHeader*)frame;
+        const StreamHeader *header      =
+            (const StreamHeader*)(frame + sizeof(FrameHeader));
+        if (length < (int)sizeof(FrameHeader) ||
+            (frameHeader->flags & FRAME_ACK)) {
+            return 0;                       // runt or stray ack
+        } // end if (length < sizeof(FrameHeader)...)
+        if (frameHeader->flags & FRAME_STREAM) {
+            sendAck(STREAMMAX, 0);          // a probe for grants
+            return 0;
+        } // end if (flags & FRAME_STREAM)
+        if (length < (int)(sizeof(FrameHeader) + sizeof(StreamHeader)) ||
+            header->stream >= (uint32_t)streams) {
+            return 0;                       // malformed
+        } // end if (length < ...)
+        uint32_t stream = header->stream;
+        if (SeqSpace::before(header->seq, nextDeliver[stream])) {
+            sendAck(stream, header->seq);   // read already
+            return 0;
+        } // end if (SeqSpace::before(header->seq...))
+        if (SeqSpace::diff(header->seq, nextDeliver[stream]) >= capacity) {
+            ++overruns;                     // beyond any grant sent
+            sendAck(STREAMMAX, 0);
+            return 0;
+        } // end if (SeqSpace::diff(...) >= capacity)
+        int slot = index(stream, header->seq);
+        int kept = 0;
+        if (lengths[slot] == EMPTY) {
+            length -= sizeof(FrameHeader) + sizeof(StreamHeader);
+            memcpy(&frames[slot * MSGSIZE],
+                   frame + sizeof(FrameHeader) + sizeof(StreamHeader), length);
+            lengths[slot] = length;
+            kept = 1;
+        } // end if (lengths[slot] == EMPTY)
+        sendAck(stream, header->seq);
+        return kept;
+    } // end onFrame(const char[], int)
+
+    /**
+     * Copies the payload of the next message of stream into msg[], and
+     *  grants the sender more of the stream once half a window has opened
+     *  since the last grant, so a sender held back by the grant resumes.
+     * @param  msg  container of at least STREAMPAYLOAD bytes.
+     * @return Bytes of payload, or -1 if that message has not arrived.
+     */
+    int read(int stream, char msg[]) {
+        int slot = index(stream, nextDeliver[stream]);
+        if (lengths[slot] == EMPTY) {
+            return -1;
+        } // end if (lengths[slot] == EMPTY)
+        int length = lengths[slot];
+        memcpy(msg, &frames[slot * MSGSIZE], length);
+        lengths[slot] = EMPTY;
+        ++nextDeliver[stream];
+        if (SeqSpace::diff(nextDeliver[stream] + capacity, granted[stream])
+                >= (capacity + 1) / 2) {
+            ++updates;
+            sendAck(STREAMMAX, 0);
+        } // end if (SeqSpace::diff(...) >= (capacity + 1) / 2)
+        return length;
+    } // end read(int, char[])
+
+    /**
+     * Answers the sender's resends and probes once the last message has
+     *  been read, until quiet usec pass with nothing arriving, so a final
+     *  ack that was lost is sent again.
+     */
+    void linger(long quiet) {
+        while (sock.pollRecvFrom(quiet) > 0) {
+            receive();
+        } // end while(sock.pollRecvFrom(quiet) > 0)
+    } // end linger(long)
+
+    bool ready(int stream) const {
+        return lengths[index(stream, nextDeliver[stream])] != EMPTY;
+    } // end ready(int)
+    int  grants() const { return updates; }
+    int  overrun() const { return overruns; }
+
+ private:
+    static const int EMPTY = -1;    // length of a slot with no message
+
+    int index(int stream, uint32_t seq) const {
+        return stream * space.size() + space.slot(seq);
+    } // end index(int, uint32_t)
+
+    /**
+     * Acknowledges message seq of stream, or nothing if stream is
+     *  STREAMMAX, granting every stream up to a window past its reader.
+     */
+    void sendAck(uint32_t stream, uint32_t seq) {
+        StreamAckHeader ack;
+        ack.seq    = seq;
+        ack.flags  = FRAME_ACK | FRAME_STREAM;
+        ack.stream = stream;
+        for (int s = 0; s < streams; ++s) {
+            ack.limit[s] = granted[s] = nextDeliver[s] + capacity;
+        } // end for (; s < streams; )
+        sock.ackTo((char*)&ack, (3 + streams) * sizeof(uint32_t));
+    } // end sendAck(uint32_t, uint32_t)
+
+    Transport            &sock;         // carries frames in and acks out
+    int                   capacity;     // messages each reader has room for
+    SeqSpace              space;        // maps stream sequences to slots
+    int                   streams;      // number of streams
+    std::vector<char>     frames;       // payloads waiting, ring per stream
+    std::vector<int>      lengths;      // bytes of each payload, or EMPTY
+    std::vector<uint32_t> nextDeliver;  // next message to read, per stream
+    std::vector<uint32_t> granted;      // limit last sent, per stream
+    int                   updates;      // acks sent only to grant
+    int                   overruns;     // frames beyond the grant, dropped
+};
+
+#endif
@@ -4,22 +4,65 @@
 // Date:         March 5, 2004
 
 #include "UdpSocket.h"
+#include <map>
+#include <string>
+#include <mutex>
+
+// Resolved-address cache shared by every UdpSocket --------------------------
+// Names are resolved once per process and family; the lock is held only to
+// look up or insert, never across getaddrinfo( ), so sessions that resolve
+// different names at the same time do not wait on each other.
+static map<string, struct sockaddr_storage> resolved;
+static mutex resolvedLock;
+
+// Read the ECN bits from the TOS byte or traffic class a datagram came with --
+static unsigned char ecnOf( struct msghdr *hdr ) {
+  for ( struct cmsghdr *c = CMSG_FIRSTHDR( hdr ); c != NULL;
+	c = CMSG_NXTHDR( hdr, c ) ) {
+    if ( c->cmsg_level == IPPROTO_IP && c->cmsg_type == IP_TOS )
+      return *(unsigned char *)CMSG_DATA( c ) & ECN_CE;
+    if ( c->cmsg_level == IPPROTO_IPV6 && c->cmsg_type == IPV6_TCLASS ) {
+      int tclass;
+      memcpy( &tclass, CMSG_DATA( c ), sizeof( tclass ) );
+      return tclass & ECN_CE;
+    }
+  }
+  return ECN_NOT;
+}
 
 // Constructor ----------------------------------------------------------------
-UdpSocket::UdpSocket( int port ) : port( port ), sd( NULL_SD ) {
+UdpSocket::UdpSocket( int port ) : port( port ), sd( NULL_SD ),
+				    family( AF_INET6 ), connected( false ),
+				    destLen( 0 ), srcLen( 0 ), ecn( -1 ) {
 
-  // Open a UDP socket (a datagram socket )
-  if( ( sd = socket( AF_INET, SOCK_DGRAM, 0 ) ) < 0 ) {
+  // Open a dual-stack UDP socket (a datagram socket ) that also accepts
+  // IPv4 peers as v4-mapped addresses, or fall back to IPv4 only
+  if( ( sd = socket( AF_INET6, SOCK_DGRAM, 0 ) ) >= 0 ) {
+    int off = 0;
+    setsockopt( sd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof( off ) );
+  }
+  else if( ( sd = socket( family = AF_INET, SOCK_DGRAM, 0 ) ) < 0 ) {
     cerr << "Cannot open a UDP socket." << endl;
   }
 
   // Bind our local address
   bzero( (char*)&myAddr, sizeof( myAddr ) );    // Zero-initialize myAddr
-  myAddr.sin_family      = AF_INET;             // Use address family internet
-  myAddr.sin_addr.s_addr = htonl( INADDR_ANY ); // Receive from any addresses
-  myAddr.sin_port        = htons( port );       // Set my socket port
+  if ( family == AF_INET6 ) {
+    struct sockaddr_in6 *my6 = (struct sockaddr_in6 *)&myAddr;
+    my6->sin6_family = AF_INET6;                // Use address family IPv6
+    my6->sin6_addr   = in6addr_any;             // Receive from any addresses
+    my6->sin6_port   = htons( port );           // Set my socket port
+  }
+  else {
+    struct sockaddr_in *my4 = (struct sockaddr_in *)&myAddr;
+    my4->sin_family      = AF_INET;             // Use address family internet
+    my4->sin_addr.s_addr = htonl( INADDR_ANY ); // Receive from any addresses
+    my4->sin_port        = htons( port );       // Set my socket port
+  }
     
-  if( bind( sd, (sockaddr*)&myAddr, sizeof( myAddr ) ) < 0 ) {
+  socklen_t myLen = ( family == AF_INET6 ) ? sizeof( struct sockaddr_in6 )
+                                           : sizeof( struct sockaddr_in );
+  if( bind( sd, (sockaddr*)&myAddr, myLen ) < 0 ) {
     cerr << "Cannot bind the local address to the UDP socket." << endl;
   }
 }
@@ -34,52 +77,168 @@ UdpSocket::~UdpSocket( ) {
 // Set the IP addr given a destination IP name in char[] ----------------------
 bool UdpSocket::setDestAddress( char ipName[] ) {
 
-  // Get the host entry corresponding to this destination ipName
-  struct hostent* host = gethostbyname( ipName );
-  if( host == NULL ) {
-    cerr << "Cannot find hostname." << endl;
-    return false;                                // set in failure
+  // Look for an earlier resolution of this ipName for our address family
+  string key = string( ipName ) + ( family == AF_INET6 ? "/6" : "/4" );
+  bool cached = false;
+  {
+    lock_guard<mutex> guard( resolvedLock );
+    map<string, struct sockaddr_storage>::iterator it = resolved.find( key );
+    if ( it != resolved.end( ) ) {
+      destAddr = it->second;
+      cached = true;
+    }
   }
 
-  // Fill in the structure "sendSockAddr" with this destination host entry
-  bzero( (char*)&destAddr, sizeof( destAddr ) ); // zero-initialize
-  destAddr.sin_family      = AF_INET;            // Use address family internet
-  destAddr.sin_addr.s_addr =                     // set the destination IP addr
-    inet_addr( inet_ntoa( *(struct in_addr*)*host->h_addr_list ) );
-  destAddr.sin_port        = htons( port );      // set the destination port
+  if ( !cached ) {
+    // Resolve ipName; a dual-stack socket asks for IPv6 addresses and has
+    // IPv4-only hosts returned as v4-mapped addresses
+    struct addrinfo hints, *result = NULL;
+    bzero( (char*)&hints, sizeof( hints ) );
+    hints.ai_family   = family;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags    = ( family == AF_INET6 ) ? AI_V4MAPPED : 0;
+    int error = getaddrinfo( ipName, NULL, &hints, &result );
+    if( error != 0 || result == NULL ) {
+      cerr << "Cannot find hostname: " << gai_strerror( error ) << endl;
+      return false;                              // set in failure
+    }
+    bzero( (char*)&destAddr, sizeof( destAddr ) ); // zero-initialize
+    memcpy( &destAddr, result->ai_addr, result->ai_addrlen );
+    freeaddrinfo( result );
+
+    lock_guard<mutex> guard( resolvedLock );
+    resolved[key] = destAddr;
+  }
+
+  // Set the destination port
+  if ( family == AF_INET6 ) {
+    ( (struct sockaddr_in6 *)&destAddr )->sin6_port = htons( port );
+    destLen = sizeof( struct sockaddr_in6 );
+  }
+  else {
+    ( (struct sockaddr_in *)&destAddr )->sin_port = htons( port );
+    destLen = sizeof( struct sockaddr_in );
+  }
 
   return true;                                   // set in success
 }
 
-// Check if this socket has data to receive -----------------------------------
-int UdpSocket::pollRecvFrom( ) {
+// Copy the destination address set by setDestAddress( ) into addr ----------
+// Returns the bytes of it in use, 0 if none has been set.
+socklen_t UdpSocket::getDestAddress( struct sockaddr_storage *addr ) {
+  memcpy( addr, &destAddr, sizeof( destAddr ) );
+  return destLen;
+}
+
+// Connect the socket to the destination address ----------------------------
+// The kernel then resolves the route once instead of on every datagram and
+// drops datagrams from any other peer. Call after setDestAddress( ).
+bool UdpSocket::connectDest( ) {
+  if ( connect( sd, (sockaddr *)&destAddr, destLen ) < 0 ) {
+    cerr << "Cannot connect the UDP socket to the destination." << endl;
+    return false;
+  }
+  connected = true;
+  return true;
+}
+
+// Connect the socket to the source of the previous recvFrom( ) --------------
+// Lets a server lock onto the one client of a point-to-point session.
+bool UdpSocket::connectSrc( ) {
+  if ( connect( sd, (sockaddr *)&srcAddr, srcLen ) < 0 ) {
+    cerr << "Cannot connect the UDP socket to the source." << endl;
+    return false;
+  }
+  connected = true;
+  return true;
+}
+
+// Check if this socket has data to receive, waiting up to usec for some -----
+int UdpSocket::pollRecvFrom( long usec ) {
   struct pollfd pfd[1];
   pfd[0].fd = sd;             // declare I'll check the data availability of sd
   pfd[0].events = POLLRDNORM; // declare I'm interested in only reading from sd
 
   // check it immediately and return a positive number if sd is readable,
   // otherwise return 0 or a negative number
-  return poll( pfd, 1, 0 );
+  if ( usec <= 0 )
+    return poll( pfd, 1, 0 );
+
+  // sleep until sd is readable or usec passes, at finer grain than poll( )
+  struct timespec timeout;
+  timeout.tv_sec = usec / 1000000;
+  timeout.tv_nsec = usec % 1000000 * 1000;
+  return ppoll( pfd, 1, &timeout, NULL );
 }
 
 // Send msg[] of length size through the sd socket ----------------------------
 int UdpSocket::sendTo( char msg[], int length ) {
 
-  // return the number of bytes sent
-  return sendto( sd, msg, length, 0, (sockaddr *)&destAddr, 
-		 sizeof( destAddr ) );
+  // return the number of bytes sent; a connected socket already knows where
+  if ( connected )
+    return send( sd, msg, length, 0 );
+  return sendto( sd, msg, length, 0, (sockaddr *)&destAddr, destLen );
 }
 
 // Receive data through the sd socket and store it in msg[] of lenth size -----
 int UdpSocket::recvFrom( char msg[], int length ) {
-  
+
+  // the TOS byte comes as ancillary data, which only recvmsg( ) reads
+  if ( ecn >= 0 )
+    return receive( msg, length );
+
+  // a connected socket only receives from its peer, so skip the address
+  if ( connected )
+    return recv( sd, msg, length, 0 );
+
   // zero-initialize the srcAddr structure so that it can be filled out with
   // the address of the source computer that has sent msg[]
-  socklen_t addrlen = sizeof( srcAddr );
+  srcLen = sizeof( srcAddr );
   bzero( (char *)&srcAddr, sizeof( srcAddr ) );
 
   // return the number of bytes received
-  return recvfrom( sd, msg, length, 0, &srcAddr, &addrlen );
+  return recvfrom( sd, msg, length, 0, (sockaddr *)&srcAddr, &srcLen );
+}
+
+// Receive without blocking up to count messages of length size each into ----
+// consecutive length-byte slots of msgs[], storing each message's size in
+// sizes[]. Returns how many arrived, 0 if none were waiting.
+int UdpSocket::recvBatch( char msgs[], int length, int sizes[], int count ) {
+  struct mmsghdr hdrs[count];
+  struct iovec iovs[count];
+  struct sockaddr_storage addrs[count];
+  char controls[ecn >= 0 ? count : 1][CMSG_SPACE( sizeof( int ) )];
+
+  // point every header at its own slot and source address, and at room for
+  // the TOS byte once ECN is on
+  bzero( (char *)hdrs, sizeof( hdrs ) );
+  for ( int i = 0; i < count; i++ ) {
+    iovs[i].iov_base = msgs + i * length;
+    iovs[i].iov_len = length;
+    hdrs[i].msg_hdr.msg_iov = &iovs[i];
+    hdrs[i].msg_hdr.msg_iovlen = 1;
+    hdrs[i].msg_hdr.msg_name = &addrs[i];
+    hdrs[i].msg_hdr.msg_namelen = sizeof( addrs[i] );
+    if ( ecn >= 0 ) {
+      hdrs[i].msg_hdr.msg_control = controls[i];
+      hdrs[i].msg_hdr.msg_controllen = sizeof( controls[i] );
+    }
+  }
+
+  // a single system call collects everything already queued on sd
+  int received = recvmmsg( sd, hdrs, count, MSG_DONTWAIT, NULL );
+  if ( received <= 0 )
+    return 0;
+  for ( int i = 0; i < received; i++ ) {
+    sizes[i] = hdrs[i].msg_len;
+    if ( ecn >= 0 && i < ECNBATCH )
+      ecnIn[i] = ecnOf( &hdrs[i].msg_hdr );
+  }
+
+  // the last sender is the one ackTo( ) answers
+  memcpy( &srcAddr, &addrs[received - 1], sizeof( srcAddr ) );
+  srcLen = hdrs[received - 1].msg_hdr.msg_namelen;
+  return received;
 }
 
 // Send through the sd socket an acknowledgment in msg[] whose size is length -
@@ -89,5 +248,71 @@ int UdpSocket::ackTo( char msg[], int length ) {
   // method.
 
   // return the number of bytes sent
-  return sendto( sd, msg, length, 0, &srcAddr, sizeof( srcAddr ) );
+  if ( connected )
+    return send( sd, msg, length, 0 );
+  return sendto( sd, msg, length, 0, (sockaddr *)&srcAddr, srcLen );
+}
+
+// Get the socket descriptor so that an event loop can wait on it ------------
+int UdpSocket::getDescriptor( ) {
+  return sd;
+}
+
+// Mark every datagram sent with an ECN codepoint and read the codepoint of --
+// every datagram received. ECN_NOT stops marking but keeps reading. The
+// kernel is asked only when the codepoint changes, so a marker may call this
+// before every send.
+bool UdpSocket::setEcn( int codepoint ) {
+  if ( codepoint == ecn )
+    return true;
+
+  // a dual-stack socket sends to v4-mapped peers with the IPv4 TOS byte and
+  // to IPv6 peers with the traffic class, so set both
+  bool ok = setsockopt( sd, IPPROTO_IP, IP_TOS, &codepoint,
+			sizeof( codepoint ) ) == 0;
+  if ( family == AF_INET6 )
+    ok = setsockopt( sd, IPPROTO_IPV6, IPV6_TCLASS, &codepoint,
+		     sizeof( codepoint ) ) == 0 || ok;
+  if ( ecn < 0 ) {
+    int on = 1;
+    setsockopt( sd, IPPROTO_IP, IP_RECVTOS, &on, sizeof( on ) );
+    if ( family == AF_INET6 )
+      setsockopt( sd, IPPROTO_IPV6, IPV6_RECVTCLASS, &on, sizeof( on ) );
+    bzero( (char *)ecnIn, sizeof( ecnIn ) );
+  }
+  if ( !ok )
+    cerr << "Cannot set the ECN codepoint of the UDP socket." << endl;
+  ecn = codepoint;
+  return ok;
+}
+
+// Get the ECN codepoint of the i-th datagram of the last recvBatch( ), or of
+// the last recvFrom( ) for i = 0. ECN_NOT until setEcn( ) is called.
+int UdpSocket::getEcn( int i ) {
+  return ( ecn >= 0 && i < ECNBATCH ) ? ecnIn[i] : ECN_NOT;
+}
+
+// Receive one datagram with recvmsg( ), keeping its ECN codepoint -----------
+int UdpSocket::receive( char msg[], int length ) {
+  struct iovec iov;
+  struct msghdr hdr;
+  char control[CMSG_SPACE( sizeof( int ) )];
+  iov.iov_base = msg;
+  iov.iov_len = length;
+  bzero( (char *)&hdr, sizeof( hdr ) );
+  hdr.msg_iov = &iov;
+  hdr.msg_iovlen = 1;
+  hdr.msg_control = control;
+  hdr.msg_controllen = sizeof( control );
+  if ( !connected ) {
+    srcLen = sizeof( srcAddr );
+    bzero( (char *)&srcAddr, sizeof( srcAddr ) );
+    hdr.msg_name = &srcAddr;
+    hdr.msg_namelen = srcLen;
+  }
+  int received = recvmsg( sd, &hdr, 0 );
+  if ( !connected )
+    srcLen = hdr.msg_namelen;
+  ecnIn[0] = ecnOf( &hdr );
+  return received;
 }
@@ -18,30 +18,50 @@ extern "C"
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
-#include <netdb.h>        // for gethostbyname( )
+#include <netdb.h>        // for getaddrinfo( )
 #include <unistd.h>       // for close( )
 #include <string.h>       // for bzero( )
 
 #include <sys/poll.h>     // for poll( )
+#include <sys/uio.h>      // for recvmmsg( )
 }
 
 #define NULL_SD -1        // means no socket descriptor
 
+#define ECN_NOT 0x00      // ECN codepoints of the IP TOS byte: not capable
+#define ECN_ECT0 0x02     // ECN-capable transport (0)
+#define ECN_CE 0x03       // congestion experienced
+#define ECNBATCH 64       // datagrams of a recvBatch( ) whose ECN is kept
+
 class UdpSocket {
  public:
   UdpSocket( int );              // open an UDP socket with int port
   ~UdpSocket( );
   bool setDestAddress( char[] ); // set the IP addr given an IP name in char[]
-  int pollRecvFrom( );           // check if this socket has data to receive
+  socklen_t getDestAddress( struct sockaddr_storage * ); // copy it out
+  bool connectDest( );           // fix the peer to the destination address
+  bool connectSrc( );            // fix the peer to the last source address
+  int pollRecvFrom( long = 0 ); // check if this socket has data to receive
   int sendTo( char[], int );     // send a message in char[] whose size is int
   int recvFrom( char[], int );   // receive a message in char[] of int size
+  int recvBatch( char[], int, int[], int ); // drain up to int messages
   int ackTo( char[], int );      // send an ack message in char[] of int size
+  int getDescriptor( );          // the socket descriptor, for event loops
+  bool setEcn( int );            // mark sent datagrams with an ECN codepoint
+  int getEcn( int = 0 );         // ECN of the int-th datagram last received
  private:
+  int receive( char[], int );    // recvFrom( ) that reads the TOS byte too
   int port;                      // this UDP port
   int sd;                        // this UDP socket descriptor
-  struct sockaddr_in myAddr;     // my socket address for internet
-  struct sockaddr_in destAddr;   // a destination socket address for internet
-  struct sockaddr srcAddr;       // a source socket address for internet
+  int family;                    // AF_INET6 (dual-stack) or AF_INET
+  bool connected;                // whether the kernel holds the peer address
+  struct sockaddr_storage myAddr;   // my socket address for internet
+  struct sockaddr_storage destAddr; // a destination socket address
+  socklen_t destLen;                // bytes of destAddr in use
+  struct sockaddr_storage srcAddr;  // a source socket address
+  socklen_t srcLen;                 // bytes of srcAddr in use
+  int ecn;                          // codepoint sent datagrams carry, or -1
+  unsigned char ecnIn[ECNBATCH];    // codepoint of each datagram received
 };  
 
 #endif  
@@ -0,0 +1,551 @@
+/*
+ * @file   XdpSocket.cpp
+ * @brief  Implements the AF_XDP transport declared in XdpSocket.h.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#include "XdpSocket.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/bpf.h>
+#include <linux/if_link.h>
+
+static const int ETHLEN = 14;                   // Ethernet header bytes
+static const int IPLEN  = 20;                   // IPv4 header, no options
+static const int UDPLEN = 8;                    // UDP header bytes
+static const int HDRLEN = ETHLEN + IPLEN + UDPLEN;
+static const int NEIGHBOR_TRIES = 100;          // neighbor table lookups
+
+static long bpf(int cmd, union bpf_attr *attr) {
+    return syscall(SYS_bpf, cmd, attr, sizeof(*attr));
+} // end bpf(int, union bpf_attr*)
+
+static struct bpf_insn insn(uint8_t code, uint8_t dst, uint8_t src,
+                            int16_t off, int32_t imm) {
+    struct bpf_insn i;
+    i.code    = code;
+    i.dst_reg = dst;
+    i.src_reg = src;
+    i.off     = off;
+    i.imm     = imm;
+    return i;
+} // end insn(uint8_t, uint8_t, uint8_t, int16_t, int32_t)
+
+static uint16_t checksum(const unsigned char *data, int length) {
+    uint32_t sum = 0;
+    for (int i = 0; i + 1 < length; i += 2) {
+        sum += (data[i] << 8) | data[i + 1];
+    } // end for (; i + 1 < length; )
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    } // end while(sum >> 16)
+    return htons(~sum & 0xffff);
+} // end checksum(const unsigned char*, int)
+
+
+/**
+ * Opens the socket, registers the UMEM, maps the four rings and attaches
+ *  the steering program to queue of ifName. Check isOpen() afterwards; a
+ *  failure is reported on cerr and leaves the socket closed.
+ * @param  port  this UDP port.
+ * @param  ifName  interface to bind, e.g. one end of a veth pair.
+ * @param  queue  interface queue to bind.
+ */
+XdpSocket::XdpSocket(int port, const char ifName[], int queue)
+    : port(port), queue(queue), ifIndex(if_nametoindex(ifName)),
+      ifName(ifName), sd(NULL_SD), mapFd(NULL_SD), progFd(NULL_SD),
+      linkFd(NULL_SD), umem(NULL), destIp(0), srcIp(0), srcPort(0),
+      ipId(0) {
+    bzero((char*)&fill, sizeof(fill));
+    bzero((char*)&comp, sizeof(comp));
+    bzero((char*)&rx, sizeof(rx));
+    bzero((char*)&tx, sizeof(tx));
+    if (ifIndex == 0 || !localAddress()) {
+        cerr << "Cannot find the interface " << ifName << "." << endl;
+        return;
+    } // end if (ifIndex == 0...)
+    if ((sd = socket(AF_XDP, SOCK_RAW, 0)) < 0) {
+        cerr << "Cannot open an AF_XDP socket." << endl;
+        return;
+    } // end if ((sd = socket(AF_XDP...)) < 0)
+    if (!openUmem()) {
+        close(sd);
+        sd = NULL_SD;
+        return;
+    } // end if (!openUmem())
+
+    // bind in copy mode so generic XDP on any driver can feed us
+    struct sockaddr_xdp addr;
+    bzero((char*)&addr, sizeof(addr));
+    addr.sxdp_family   = AF_XDP;
+    addr.sxdp_ifindex  = ifIndex;
+    addr.sxdp_queue_id = queue;
+    addr.sxdp_flags    = XDP_COPY | XDP_USE_NEED_WAKEUP;
+    if (bind(sd, (sockaddr*)&addr, sizeof(addr)) < 0 || !loadProgram()) {
+        cerr << "Cannot bind the AF_XDP socket to " << ifName << "." << endl;
+        close(sd);
+        sd = NULL_SD;
+        return;
+    } // end if (bind(sd...) < 0...)
+    refill();
+} // end XdpSocket(int, const char[], int)
+
+
+XdpSocket::~XdpSocket() {
+    XdpRing *rings[] = { &fill, &comp, &rx, &tx };
+    for (int i = 0; i < 4; ++i) {
+        if (rings[i]->map != NULL) {
+            munmap(rings[i]->map, rings[i]->mapLen);
+        } // end if (rings[i]->map != NULL)
+    } // end for (; i < 4; )
+    int fds[] = { linkFd, progFd, mapFd, sd };
+    for (int i = 0; i < 4; ++i) {
+        if (fds[i] != NULL_SD) {
+            close(fds[i]);              // closing the link detaches
+        } // end if (fds[i] != NULL_SD)
+    } // end for (; i < 4; )
+    if (umem != NULL) {
+        munmap(umem, (size_t)XDPFRAMES * XDPFRAMESIZE);
+    } // end if (umem != NULL)
+} // end ~XdpSocket()
+
+
+/**
+ * Resolves ipName to an IPv4 address and its link-layer address. The peer
+ *  must be on the link of this interface; a datagram is sent to it through
+ *  the normal stack first so the kernel resolves its neighbor entry.
+ * @param  ipName  name or dotted address of the peer.
+ * @return true if both addresses are known.
+ */
+bool XdpSocket::setDestAddress(char ipName[]) {
+    struct addrinfo hints, *result = NULL;
+    bzero((char*)&hints, sizeof(hints));
+    hints.ai_family   = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(ipName, NULL, &hints, &result) != 0 || result == NULL) {
+        cerr << "Cannot find hostname." << endl;
+        return false;
+    } // end if (getaddrinfo(...) != 0...)
+    destIp = ((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr;
+    freeaddrinfo(result);
+    if (!neighbor(destIp, destMac)) {
+        cerr << "Cannot find the link address of " << ipName << "." << endl;
+        return false;
+    } // end if (!neighbor(destIp, destMac))
+    return true;
+} // end setDestAddress(char[])
+
+
+/**
+ * @return Number of frames waiting in the rx ring, 0 if none.
+ *          The ring is only ever polled, so usec is ignored.
+ */
+int XdpSocket::pollRecvFrom(long) {
+    if (sd == NULL_SD) {
+        return 0;
+    } // end if (sd == NULL_SD)
+    uint32_t avail = __atomic_load_n(rx.producer, __ATOMIC_ACQUIRE) -
+                     *rx.consumer;
+    if (avail == 0 && (*fill.flags & XDP_RING_NEED_WAKEUP)) {
+        recvfrom(sd, NULL, 0, MSG_DONTWAIT, NULL, NULL);
+    } // end if (avail == 0...)
+    return avail;
+} // end pollRecvFrom(long)
+
+
+/**
+ * Sends msg[] to the destination set by setDestAddress().
+ * @return length, or -1 if no UMEM frame or tx slot was free.
+ */
+int XdpSocket::sendTo(char msg[], int length) {
+    int sent = post(msg, length, destMac, destIp, port);
+    kick();
+    return sent;
+} // end sendTo(char[], int)
+
+
+/**
+ * Sends count messages of sizes[] bytes from consecutive length-byte slots
+ *  of msgs[] with a single wakeup of the kernel.
+ * @return Number of messages queued for transmission.
+ */
+int XdpSocket::sendBatch(char msgs[], int length, int sizes[], int count) {
+    int sent = 0;
+    while (sent < count &&
+           post(msgs + sent * length, sizes[sent], destMac, destIp, port) >= 0) {
+        ++sent;
+    } // end while(sent < count...)
+    kick();
+    return sent;
+} // end sendBatch(char[], int, int[], int)
+
+
+/**
+ * Blocks until a datagram arrives and copies its payload into msg[].
+ * @return Bytes received, truncated to length.
+ */
+int XdpSocket::recvFrom(char msg[], int length) {
+    int sizes[1];
+    while (recvBatch(msg, length, sizes, 1) < 1) {
+        struct pollfd pfd;
+        pfd.fd     = sd;
+        pfd.events = POLLIN;
+        poll(&pfd, 1, 10);
+    } // end while(recvBatch(...) < 1)
+    return sizes[0];
+} // end recvFrom(char[], int)
+
+
+/**
+ * Takes up to count frames from the rx ring without blocking, copies their
+ *  UDP payloads into consecutive length-byte slots of msgs[] and returns
+ *  the frames to the fill ring in one batch.
+ * @return Number of datagrams received, 0 if none were waiting.
+ */
+int XdpSocket::recvBatch(char msgs[], int length, int sizes[], int count) {
+    if (pollRecvFrom() < 1) {
+        return 0;
+    } // end if (pollRecvFrom() < 1)
+    struct xdp_desc *descs = (struct xdp_desc*)rx.descs;
+    uint32_t cons  = *rx.consumer;
+    uint32_t prod  = __atomic_load_n(rx.producer, __ATOMIC_ACQUIRE);
+    uint64_t *ring = (uint64_t*)fill.descs;
+    uint32_t fillProd = *fill.producer;
+    int received = 0;
+    for (; cons != prod && received < count; ++cons) {
+        struct xdp_desc &desc = descs[cons & (XDPRINGSIZE - 1)];
+        unsigned char *frame  = (unsigned char*)umem + desc.addr;
+        // hand the frame straight back to the kernel for the next arrival
+        ring[fillProd++ & (XDPRINGSIZE - 1)] =
+            desc.addr & ~(uint64_t)(XDPFRAMESIZE - 1);
+        if (desc.len < (uint32_t)HDRLEN) {
+            continue;                   // the program only passes UDP
+        } // end if (desc.len < HDRLEN)
+        int payload = ntohs(*(uint16_t*)(frame + ETHLEN + IPLEN + 4)) - UDPLEN;
+        if (payload < 0 || payload > (int)desc.len - HDRLEN) {
+            continue;
+        } // end if (payload < 0...)
+        // remember the source so that ackTo() can answer it
+        memcpy(srcMac, frame + 6, 6);
+        memcpy(&srcIp, frame + ETHLEN + 12, 4);
+        memcpy(&srcPort, frame + ETHLEN + IPLEN, 2);
+        sizes[received] = payload < length ? payload : length;
+        memcpy(msgs + received * length, frame + HDRLEN, sizes[received]);
+        ++received;
+    } // end for (; cons != prod...)
+    __atomic_store_n(rx.consumer, cons, __ATOMIC_RELEASE);
+    __atomic_store_n(fill.producer, fillProd, __ATOMIC_RELEASE);
+    return received;
+} // end recvBatch(char[], int, int[], int)
+
+
+/**
+ * Sends msg[] back to the source of the last datagram received.
+ */
+int XdpSocket::ackTo(char msg[], int length) {
+    int sent = post(msg, length, srcMac, srcIp, ntohs(srcPort));
+    kick();
+    return sent;
+} // end ackTo(char[], int)
+
+
+/**
+ * Allocates and registers the UMEM, then maps all four rings.
+ */
+bool XdpSocket::openUmem() {
+    size_t size = (size_t)XDPFRAMES * XDPFRAMESIZE;
+    umem = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (umem == MAP_FAILED) {
+        umem = NULL;
+        return false;
+    } // end if (umem == MAP_FAILED)
+    struct xdp_umem_reg reg;
+    bzero((char*)&reg, sizeof(reg));
+    reg.addr       = (uint64_t)umem;
+    reg.len        = size;
+    reg.chunk_size = XDPFRAMESIZE;
+    reg.headroom   = 0;
+    if (setsockopt(sd, SOL_XDP, XDP_UMEM_REG, &reg, sizeof(reg)) < 0) {
+        cerr << "Cannot register the UMEM." << endl;
+        return false;
+    } // end if (setsockopt(sd...) < 0)
+
+    struct xdp_mmap_offsets off;
+    socklen_t optLen = sizeof(off);
+    int ringSize = XDPRINGSIZE;
+    if (setsockopt(sd, SOL_XDP, XDP_UMEM_FILL_RING, &ringSize,
+                   sizeof(ringSize)) < 0 ||
+        setsockopt(sd, SOL_XDP, XDP_UMEM_COMPLETION_RING, &ringSize,
+                   sizeof(ringSize)) < 0 ||
+        getsockopt(sd, SOL_XDP, XDP_MMAP_OFFSETS, &off, &optLen) < 0 ||
+        !mapRing(fill, XDP_UMEM_FILL_RING, XDP_UMEM_PGOFF_FILL_RING,
+                 off.fr.desc, sizeof(uint64_t), off.fr) ||
+        !mapRing(comp, XDP_UMEM_COMPLETION_RING,
+                 XDP_UMEM_PGOFF_COMPLETION_RING, off.cr.desc,
+                 sizeof(uint64_t), off.cr) ||
+        !mapRing(rx, XDP_RX_RING, XDP_PGOFF_RX_RING, off.rx.desc,
+                 sizeof(struct xdp_desc), off.rx) ||
+        !mapRing(tx, XDP_TX_RING, XDP_PGOFF_TX_RING, off.tx.desc,
+                 sizeof(struct xdp_desc), off.tx)) {
+        cerr << "Cannot map the AF_XDP rings." << endl;
+        return false;
+    } // end if (setsockopt(...) < 0...)
+
+    // the first half of the frames wait in the fill ring, the rest send
+    for (uint64_t i = XDPFRAMES / 2; i < XDPFRAMES; ++i) {
+        freeFrames.push_back(i * XDPFRAMESIZE);
+    } // end for (; i < XDPFRAMES; )
+    return true;
+} // end openUmem()
+
+
+/**
+ * Sizes one ring (the umem rings are already sized) and maps it.
+ */
+bool XdpSocket::mapRing(XdpRing &ring, int optName, uint64_t pgoff,
+                        size_t descOff, size_t descSize,
+                        const struct xdp_ring_offset &offsets) {
+    int ringSize = XDPRINGSIZE;
+    if ((optName == XDP_RX_RING || optName == XDP_TX_RING) &&
+        setsockopt(sd, SOL_XDP, optName, &ringSize, sizeof(ringSize)) < 0) {
+        return false;
+    } // end if ((optName == XDP_RX_RING...)
+    ring.mapLen = descOff + XDPRINGSIZE * descSize;
+    ring.map    = mmap(NULL, ring.mapLen, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, sd, pgoff);
+    if (ring.map == MAP_FAILED) {
+        ring.map = NULL;
+        return false;
+    } // end if (ring.map == MAP_FAILED)
+    ring.producer = (uint32_t*)((char*)ring.map + offsets.producer);
+    ring.consumer = (uint32_t*)((char*)ring.map + offsets.consumer);
+    ring.flags    = (uint32_t*)((char*)ring.map + offsets.flags);
+    ring.descs    = (char*)ring.map + descOff;
+    return true;
+} // end mapRing(XdpRing&, int, uint64_t, size_t, size_t, ...)
+
+
+/**
+ * Loads the steering program, places this socket in its XSKMAP at our
+ *  queue and attaches it to the interface in generic mode. The program
+ *  redirects IPv4 UDP datagrams for port; everything else passes.
+ */
+bool XdpSocket::loadProgram() {
+    union bpf_attr attr;
+    bzero((char*)&attr, sizeof(attr));
+    attr.map_type    = BPF_MAP_TYPE_XSKMAP;
+    attr.key_size    = sizeof(int);
+    attr.value_size  = sizeof(int);
+    attr.max_entries = queue + 1;
+    if ((mapFd = bpf(BPF_MAP_CREATE, &attr)) < 0) {
+        return false;
+    } // end if ((mapFd = bpf(...)) < 0)
+    bzero((char*)&attr, sizeof(attr));
+    attr.map_fd = mapFd;
+    attr.key    = (uint64_t)&queue;
+    attr.value  = (uint64_t)&sd;
+    if (bpf(BPF_MAP_UPDATE_ELEM, &attr) < 0) {
+        return false;
+    } // end if (bpf(BPF_MAP_UPDATE_ELEM...) < 0)
+
+    // r1 = ctx; r2 = data; r3 = data_end; PASS is insns[19]
+    struct bpf_insn prog[] = {
+        insn(BPF_LDX | BPF_W | BPF_MEM, 2, 1, 0, 0),         // r2 = data
+        insn(BPF_LDX | BPF_W | BPF_MEM, 3, 1, 4, 0),         // r3 = end
+        insn(BPF_ALU64 | BPF_MOV | BPF_X, 4, 2, 0, 0),       // r4 = r2
+        insn(BPF_ALU64 | BPF_ADD | BPF_K, 4, 0, 0, HDRLEN),  // r4 += hdrs
+        insn(BPF_JMP | BPF_JGT | BPF_X, 4, 3, 14, 0),        // short: PASS
+        insn(BPF_LDX | BPF_H | BPF_MEM, 5, 2, 12, 0),        // ethertype
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 12, htons(0x0800)),
+        insn(BPF_LDX | BPF_B | BPF_MEM, 5, 2, ETHLEN, 0),    // version, ihl
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 10, 0x45),
+        insn(BPF_LDX | BPF_B | BPF_MEM, 5, 2, ETHLEN + 9, 0), // protocol
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 8, IPPROTO_UDP),
+        insn(BPF_LDX | BPF_H | BPF_MEM, 5, 2, ETHLEN + IPLEN + 2, 0),
+        insn(BPF_JMP | BPF_JNE | BPF_K, 5, 0, 6, htons(port)), // dest port
+        insn(BPF_LDX | BPF_W | BPF_MEM, 2, 1, 16, 0),        // rx queue
+        insn(BPF_LD | BPF_DW | BPF_IMM, 1, BPF_PSEUDO_MAP_FD, 0, mapFd),
+        insn(0, 0, 0, 0, 0),                                 // imm64 high
+        insn(BPF_ALU64 | BPF_MOV | BPF_K, 3, 0, 0, XDP_PASS), // fallback
+        insn(BPF_JMP | BPF_CALL, 0, 0, 0, BPF_FUNC_redirect_map),
+        insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+        insn(BPF_ALU64 | BPF_MOV | BPF_K, 0, 0, 0, XDP_PASS), // PASS
+        insn(BPF_JMP | BPF_EXIT, 0, 0, 0, 0),
+    };
+    bzero((char*)&attr, sizeof(attr));
+    attr.prog_type = BPF_PROG_TYPE_XDP;
+    attr.insns     = (uint64_t)prog;
+    attr.insn_cnt  = sizeof(prog) / sizeof(prog[0]);
+    attr.license   = (uint64_t)"MIT";
+    if ((progFd = bpf(BPF_PROG_LOAD, &attr)) < 0) {
+        return false;
+    } // end if ((progFd = bpf(BPF_PROG_LOAD...)) < 0)
+
+    bzero((char*)&attr, sizeof(attr));
+    attr.link_create.prog_fd        = progFd;
+    attr.link_create.target_ifindex = ifIndex;
+    attr.link_create.attach_type    = BPF_XDP;
+    attr.link_create.flags          = XDP_FLAGS_SKB_MODE;
+    return (linkFd = bpf(BPF_LINK_CREATE, &attr)) >= 0;
+} // end loadProgram()
+
+
+/**
+ * Reads the link-layer and IPv4 addresses of the interface.
+ */
+bool XdpSocket::localAddress() {
+    struct ifreq ifr;
+    int probe = socket(AF_INET, SOCK_DGRAM, 0);
+    bzero((char*)&ifr, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifName, IFNAMSIZ - 1);
+    bool found = ioctl(probe, SIOCGIFHWADDR, &ifr) == 0;
+    memcpy(myMac, ifr.ifr_hwaddr.sa_data, 6);
+    found = found && ioctl(probe, SIOCGIFADDR, &ifr) == 0;
+    myIp = ((struct sockaddr_in*)&ifr.ifr_addr)->sin_addr.s_addr;
+    close(probe);
+    return found;
+} // end localAddress()
+
+
+/**
+ * Finds the link-layer address of ip in the kernel's neighbor table,
+ *  prompting resolution with a datagram through the normal stack.
+ */
+bool XdpSocket::neighbor(uint32_t ip, unsigned char mac[]) {
+    struct sockaddr_in peer;
+    bzero((char*)&peer, sizeof(peer));
+    peer.sin_family      = AF_INET;
+    peer.sin_addr.s_addr = ip;
+    peer.sin_port        = htons(9);    // discard
+    int probe = socket(AF_INET, SOCK_DGRAM, 0);
+    sendto(probe, "", 0, 0, (sockaddr*)&peer, sizeof(peer));
+    close(probe);
+
+    char want[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &ip, want, sizeof(want));
+    for (int tries = 0; tries < NEIGHBOR_TRIES; ++tries) {
+        FILE *arp = fopen("/proc/net/arp", "r");
+        char line[256], addr[64], hw[64], dev[IFNAMSIZ + 1];
+        unsigned type, flags;
+        while (arp != NULL && fgets(line, sizeof(line), arp) != NULL) {
+            if (sscanf(line, "%63s 0x%x 0x%x %63s %*s %16s", addr, &type,
+                       &flags, hw, dev) == 5 && strcmp(addr, want) == 0 &&
+                (flags & 0x2) &&        // ATF_COM: resolved
+                sscanf(hw, "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &mac[0],
+                       &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) == 6) {
+                fclose(arp);
+                return true;
+            } // end if (sscanf(line...) == 5...)
+        } // end while(arp != NULL...)
+        if (arp != NULL) {
+            fclose(arp);
+        } // end if (arp != NULL)
+        usleep(10000);
+    } // end for (; tries < NEIGHBOR_TRIES; )
+    return false;
+} // end neighbor(uint32_t, unsigned char[])
+
+
+/**
+ * Gives the receive half of the UMEM to the kernel through the fill ring.
+ */
+void XdpSocket::refill() {
+    uint64_t *ring = (uint64_t*)fill.descs;
+    uint32_t  prod = *fill.producer;
+    for (uint64_t i = 0; i < XDPFRAMES / 2 && i < XDPRINGSIZE; ++i) {
+        ring[prod++ & (XDPRINGSIZE - 1)] = i * XDPFRAMESIZE;
+    } // end for (; i < XDPFRAMES / 2...)
+    __atomic_store_n(fill.producer, prod, __ATOMIC_RELEASE);
+} // end refill()
+
+
+/**
+ * Returns frames the kernel has finished sending to the free list.
+ */
+void XdpSocket::reclaim() {
+    uint64_t *ring = (uint64_t*)comp.descs;
+    uint32_t  cons = *comp.consumer;
+    uint32_t  prod = __atomic_load_n(comp.producer, __ATOMIC_ACQUIRE);
+    for (; cons != prod; ++cons) {
+        freeFrames.push_back(ring[cons & (XDPRINGSIZE - 1)]);
+    } // end for (; cons != prod; )
+    __atomic_store_n(comp.consumer, cons, __ATOMIC_RELEASE);
+} // end reclaim()
+
+
+/**
+ * Asks the kernel to transmit what the tx ring holds. Copy mode always
+ *  needs the system call; it is skipped only when the kernel says so.
+ */
+void XdpSocket::kick() {
+    if (sd != NULL_SD && (*tx.flags & XDP_RING_NEED_WAKEUP)) {
+        sendto(sd, NULL, 0, MSG_DONTWAIT, NULL, 0);
+    } // end if (sd != NULL_SD...)
+} // end kick()
+
+
+/**
+ * Writes Ethernet, IPv4 and UDP headers and msg[] into a free UMEM frame
+ *  and places it on the tx ring without waking the kernel.
+ * @return length, or -1 if no frame or tx slot was free.
+ */
+int XdpSocket::post(char msg[], int length, const unsigned char mac[],
+                    uint32_t ip, uint16_t dstPort) {
+    if (sd == NULL_SD || length > XDPFRAMESIZE - HDRLEN) {
+        return -1;
+    } // end if (sd == NULL_SD...)
+    if (freeFrames.empty()) {
+        reclaim();
+    } // end if (freeFrames.empty())
+    uint32_t prod = *tx.producer;
+    if (freeFrames.empty() ||
+        prod - __atomic_load_n(tx.consumer, __ATOMIC_ACQUIRE) == XDPRINGSIZE) {
+        errno = ENOBUFS;
+        return -1;                      // drop it, as UDP would
+    } // end if (freeFrames.empty()...)
+    uint64_t addr = freeFrames.back();
+    freeFrames.pop_back();
+
+    unsigned char *frame = (unsigned char*)umem + addr;
+    unsigned char *ip4   = frame + ETHLEN;
+    unsigned char *udp   = ip4 + IPLEN;
+    uint16_t ipLen  = htons(IPLEN + UDPLEN + length);
+    uint16_t udpLen = htons(UDPLEN + length);
+    uint16_t id     = htons(ipId++);
+    uint16_t src    = htons(port);
+    uint16_t dst    = htons(dstPort);
+    memcpy(frame, mac, 6);
+    memcpy(frame + 6, myMac, 6);
+    frame[12] = 0x08;                   // IPv4
+    frame[13] = 0x00;
+    bzero((char*)ip4, IPLEN + UDPLEN);
+    ip4[0] = 0x45;                      // version 4, five words
+    memcpy(ip4 + 2, &ipLen, 2);
+    memcpy(ip4 + 4, &id, 2);
+    ip4[6] = 0x40;                      // don't fragment
+    ip4[8] = 64;                        // time to live
+    ip4[9] = IPPROTO_UDP;
+    memcpy(ip4 + 12, &myIp, 4);
+    memcpy(ip4 + 16, &ip, 4);
+    uint16_t sum = checksum(ip4, IPLEN);
+    memcpy(ip4 + 10, &sum, 2);
+    memcpy(udp, &src, 2);
+    memcpy(udp + 2, &dst, 2);
+    memcpy(udp + 4, &udpLen, 2);        // checksum 0: none, legal on IPv4
+    memcpy(udp + UDPLEN, msg, length);
+
+    struct xdp_desc &desc =
+        ((struct xdp_desc*)tx.descs)[prod & (XDPRINGSIZE - 1)];
+    desc.addr    = addr;
+    desc.len     = HDRLEN + length;
+    desc.options = 0;
+    __atomic_store_n(tx.producer, prod + 1, __ATOMIC_RELEASE);
+    return length;
+} // end post(char[], int, const unsigned char[], uint32_t, uint16_t)
@@ -0,0 +1,89 @@
+/*
+ * @file   XdpSocket.h
+ * @brief  Declares a kernel-bypass transport with the interface of UdpSocket
+ *          built on an AF_XDP socket. Datagrams live in UMEM frames shared
+ *          with the kernel: received frames are handed back to the fill ring
+ *          and sent frames are recycled from the completion ring, so the
+ *          UMEM is the only message buffer pool. A small XDP program steers
+ *          IPv4 UDP datagrams for our port on one queue of one interface to
+ *          the socket and passes everything else to the stack. The program
+ *          attaches in generic (SKB) mode and the socket binds in copy mode,
+ *          so any interface works, veth pairs included.
+ * @author brendan
+ * @date   October 17, 2026
+ */
+
+#ifndef _XDPSOCKET_H_
+#define _XDPSOCKET_H_
+
+#include <stdint.h>
+#include <vector>
+#include <linux/if_xdp.h>
+
+#include "UdpSocket.h"      // for MSGSIZE and NULL_SD
+
+#define XDPFRAMES    4096   // UMEM frames, half for receiving, half sending
+#define XDPFRAMESIZE 2048   // bytes per UMEM frame
+#define XDPRINGSIZE  2048   // descriptors per ring, a power of two
+
+/**
+ * One side of a ring shared with the kernel. This side either produces
+ *  (fill, tx) or consumes (rx, completion) descriptors.
+ */
+struct XdpRing {
+    uint32_t *producer;     // kernel or our producer index
+    uint32_t *consumer;     // kernel or our consumer index
+    uint32_t *flags;        // XDP_RING_NEED_WAKEUP
+    void     *descs;        // uint64_t addresses or xdp_desc entries
+    void     *map;          // mapping that holds the ring
+    size_t    mapLen;       // bytes of map
+};
+
+class XdpSocket {
+ public:
+    XdpSocket(int port, const char ifName[], int queue = 0);
+    ~XdpSocket();
+    bool setDestAddress(char ipName[]);
+    int  pollRecvFrom(long usec = 0);
+    int  sendTo(char msg[], int length);
+    int  sendBatch(char msgs[], int length, int sizes[], int count);
+    int  recvFrom(char msg[], int length);
+    int  recvBatch(char msgs[], int length, int sizes[], int count);
+    int  ackTo(char msg[], int length);
+    bool isOpen() const { return sd != NULL_SD; }
+
+ private:
+    bool openUmem();
+    bool mapRing(XdpRing &ring, int optName, uint64_t pgoff, size_t descOff,
+                 size_t descSize, const struct xdp_ring_offset &offsets);
+    bool loadProgram();
+    bool localAddress();
+    bool neighbor(uint32_t ip, unsigned char mac[]);
+    void refill();
+    void reclaim();
+    void kick();
+    int  post(char msg[], int length, const unsigned char mac[],
+              uint32_t ip, uint16_t dstPort);
+
+    int                   port;         // this UDP port
+    int                   queue;        // interface queue bound to
+    int                   ifIndex;      // interface index
+    const char           *ifName;       // interface name
+    int                   sd;           // AF_XDP socket descriptor
+    int                   mapFd;        // XSKMAP the program redirects into
+    int                   progFd;       // loaded XDP program
+    int                   linkFd;       // attachment of progFd to ifIndex
+    char                 *umem;         // frame area shared with the kernel
+    XdpRing               fill, comp, rx, tx;
+    std::vector<uint64_t> freeFrames;   // UMEM frames free for sending
+    unsigned char         myMac[6];     // this interface's address
+    uint32_t              myIp;         // this interface's IPv4 address
+    unsigned char         destMac[6];   // destination, from setDestAddress
+    uint32_t              destIp;
+    unsigned char         srcMac[6];    // source of the last datagram
+    uint32_t              srcIp;
+    uint16_t              srcPort;
+    uint16_t              ipId;         // IPv4 identification counter
+};
+
+#endif
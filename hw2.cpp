@@ -1,6 +1,25 @@
 #include <iostream>
 #include "UdpSocket.h"
 #include "Timer.h"
+#include "SeqSpace.h"
+#include "Frame.h"
+#include "ShmSocket.h"
+#include "XdpSocket.h"
+#include "Async.h"
+#include "LossySocket.h"
+#include "Stream.h"
+#include "Duplex.h"
+#include "Coalesce.h"
+#include "Compress.h"
+#include "Seal.h"
+#include "Multicast.h"
+#include "Fountain.h"
+#include "Multipath.h"
+#include "Harq.h"
+#include "Ecn.h"
+#include "Stamp.h"
+#include "PathCache.h"
+#include <sys/wait.h>
 
 using namespace std;
 
@@ -8,12 +27,68 @@ using namespace std;
 #define MAX 20000        // times of message transfer
 #define MAXWIN 30        // the maximum window size
 #define LOOP 10          // loop in test 4 and 5
+#define CONNS 8          // concurrent transfers in test 8
+#define LOSS 0.01        // fraction of frames dropped in test 9
+#define LIFETIME 1000    // usec a message is worth delivering in test 9
+#define STREAMS 4        // streams of test 11, stream s with weight s + 1
+#define SMALL 64         // bytes of each message written in test 13
+#define GROUP "239.255.43.2" // multicast group of test 16
+#define RECEIVERS 4      // receiver processes the server forks in test 16
+#define HISTORY 1024     // frames the multicast sender keeps for repair
+#define CODEDLOSS 0.1    // fraction of symbols dropped in test 17
+#define PATHS 3          // ports test 19 stripes frames across
+#define CHANNELS 16      // most stop-and-wait channels test 20 interleaves
+#define ECNQUEUE 10      // unacked frames test 22's queue holds unmarked
+#define SHORT 500        // messages in each of test 25's transfers
+#define LINGER 20000     // usec a server re-acks after a pass of tests 18-25
 
 // client packet sending functions
 void clientUnreliable( UdpSocket &sock, const int max, int message[] );
 int clientStopWait( UdpSocket &sock, const int max, int message[] );
 int clientSlidingWindow( UdpSocket &sock, const int max, int message[], 
 			  int windowSize );
+int clientSlidingWindow( ShmSocket &sock, const int max, int message[], 
+			  int windowSize );
+void benchSeqArithmetic( const int max );
+void benchConnected( UdpSocket &sock, const int max, int message[] );
+void benchXdp( UdpSocket &sock, XdpSocket &xdp, const int max, 
+	       int message[] );
+Task clientAsync( Connection &conn, const int max, int &retransmits );
+Task serverAsync( Connection &conn, const int max );
+void clientDeadline( UdpSocket &sock, const int max, int message[] );
+void serverDeadline( UdpSocket &sock, const int max, int message[] );
+void clientUnordered( UdpSocket &sock, const int max, int message[] );
+void serverUnordered( UdpSocket &sock, const int max, int message[] );
+void clientStreams( UdpSocket &sock, const int max, int message[] );
+void serverStreams( UdpSocket &sock, const int max, int message[] );
+void clientDuplex( UdpSocket &sock, const int max, int message[] );
+void serverDuplex( UdpSocket &sock, const int max, int message[] );
+void clientCoalesce( UdpSocket &sock, const int max, int message[] );
+void serverCoalesce( UdpSocket &sock, const int max, int message[] );
+void clientCompress( UdpSocket &sock, const int max, int message[] );
+void serverCompress( UdpSocket &sock, const int max, int message[] );
+void clientSeal( UdpSocket &sock, const int max, int message[] );
+void serverSeal( UdpSocket &sock, const int max, int message[] );
+void clientMulticast( const int max, int message[] );
+void serverMulticast( const int max, int message[] );
+void clientFountain( const int max, int message[] );
+void serverFountain( const int max, int message[] );
+void clientNack( UdpSocket &sock, const int max, int message[] );
+void serverNack( UdpSocket &sock, const int max, int message[] );
+void clientMultipath( char server[], const int max, int message[] );
+void serverMultipath( const int max, int message[] );
+void clientHarq( char server[], const int max, int message[] );
+void serverHarq( const int max, int message[] );
+void clientScavenger( UdpSocket &sock, char server[], const int max,
+		      int message[] );
+void serverScavenger( UdpSocket &sock, const int max, int message[] );
+void clientEcn( UdpSocket &sock, const int max, int message[] );
+void serverEcn( UdpSocket &sock, const int max, int message[] );
+void clientStamp( UdpSocket &sock, const int max, int message[] );
+void serverStamp( UdpSocket &sock, const int max, int message[] );
+void clientBandwidth( UdpSocket &sock, const int max, int message[] );
+void clientWarm( UdpSocket &sock, const int max, int message[] );
+void serverWarm( UdpSocket &sock, const int max, int message[] );
 //int clientSlowAIMD( UdpSocket &sock, const int max, int message[],
 //		     int windowSize, bool rttOn );
 
@@ -22,6 +97,8 @@ void serverUnreliable( UdpSocket &sock, const int max, int message[] );
 void serverReliable( UdpSocket &sock, const int max, int message[] );
 void serverEarlyRetrans( UdpSocket &sock, const int max, int message[], 
 			 int windowSize );
+void serverEarlyRetrans( ShmSocket &sock, const int max, int message[], 
+			 int windowSize );
 //void serverEarlyRetrans( UdpSocket &sock, const int max, int message[], 
 //			 int windowSize, bool congestion );
 
@@ -50,6 +127,33 @@ int main( int argc, char *argv[] ) {
   cerr << "   1: unreliable test" << endl;
   cerr << "   2: stop-and-wait test" << endl;
   cerr << "   3: sliding windows" << endl;
+  cerr << "   4: sequence arithmetic benchmark (client only)" << endl;
+  cerr << "   5: connected send benchmark" << endl;
+  cerr << "   6: sliding windows over shared memory (same host)" << endl;
+  cerr << "   7: AF_XDP send benchmark" << endl;
+  cerr << "   8: concurrent transfers on one thread" << endl;
+  cerr << "   9: lossy transfer, reliable versus with deadlines" << endl;
+  cerr << "  10: lossy transfer, in-order versus unordered delivery" << endl;
+  cerr << "  11: lossy transfer of weighted streams on one window" << endl;
+  cerr << "  12: request/response with piggybacked acks" << endl;
+  cerr << "  13: small writes, one per frame versus coalesced" << endl;
+  cerr << "  14: sliding window, plain versus LZ4 compressed" << endl;
+  cerr << "  15: sliding window, plain versus AEAD sealed" << endl;
+  cerr << "  16: lossy multicast to " << RECEIVERS << " receivers with NACKs"
+       << endl;
+  cerr << "  17: lossy fountain-coded multicast to " << RECEIVERS
+       << " receivers" << endl;
+  cerr << "  18: lossy sliding window, acks versus NACKs" << endl;
+  cerr << "  19: sliding window on one port versus striped across " << PATHS
+       << endl;
+  cerr << "  20: interleaved stop-and-wait on 1 to " << CHANNELS
+       << " channels" << endl;
+  cerr << "  21: sliding window, fixed versus LEDBAT scavenger" << endl;
+  cerr << "  22: ECN-marking queue, fixed window versus DCTCP" << endl;
+  cerr << "  23: sliding window measuring one-way delay and skew" << endl;
+  cerr << "  24: sliding window estimating the path's bandwidth" << endl;
+  cerr << "  25: short transfers, cold versus warm from cached path metrics"
+       << endl;
   cerr << "--> ";
   cin >> testNumber;
 
@@ -84,12 +188,132 @@ int main( int argc, char *argv[] ) {
 	cerr << "retransmits = " << retransmits << endl;
       }
       break;
+    case 4:
+      benchSeqArithmetic( MAX );                               // actual test
+      break;
+    case 5:
+      benchConnected( sock, MAX, message );                    // actual test
+      break;
+    case 6: {
+      ShmSocket shm( PORT, false );         // attach to the server's rings
+      if ( shm.setDestAddress( argv[1] ) == false )
+	break;
+      for ( int windowSize = 1; windowSize <= MAXWIN; windowSize++ ) {
+	timer.start( );                                        // start timer
+	retransmits =
+	clientSlidingWindow( shm, MAX, message, windowSize );  // actual test
+	cerr << "Window size = ";                              // lap timer
+	cout << windowSize << " ";
+	cerr << "Elasped time = "; 
+	cout << timer.lap( ) << endl;
+	cerr << "retransmits = " << retransmits << endl;
+      }
+      break;
+    }
+    case 7: {
+      string ifName;                        // e.g. one end of a veth pair
+      cerr << "interface --> ";
+      cin >> ifName;
+      XdpSocket xdp( PORT, ifName.c_str( ) );
+      if ( xdp.isOpen( ) == false || xdp.setDestAddress( argv[1] ) == false )
+	break;
+      benchXdp( sock, xdp, MAX, message );                     // actual test
+      break;
+    }
+    case 8: {
+      EventLoop loop;                       // drives every connection
+      Connection *conns[CONNS];
+      int opened = 0;
+      for ( ; opened < CONNS; opened++ ) {
+	conns[opened] = new Connection( loop, PORT + 1 + opened, MAXWIN / 3 );
+	if ( conns[opened]->setDestAddress( argv[1] ) == false ) {
+	  delete conns[opened];
+	  break;
+	}
+      }
+      if ( opened == CONNS ) {
+	for ( int i = 0; i < CONNS; i++ )
+	  loop.spawn( clientAsync( *conns[i], MAX / CONNS, retransmits ) );
+	timer.start( );                                        // start timer
+	loop.run( );                                           // actual test
+	cerr << "Elasped time = ";                             // lap timer
+	cout << timer.lap( ) << endl;
+	cerr << "retransmits = " << retransmits << endl;
+      }
+      for ( int i = 0; i < opened; i++ )
+	delete conns[i];
+      break;
+    }
+    case 9:
+      clientDeadline( sock, MAX, message );                    // actual test
+      break;
+    case 10:
+      clientUnordered( sock, MAX, message );                   // actual test
+      break;
+    case 11:
+      timer.start( );                                          // start timer
+      clientStreams( sock, MAX, message );                     // actual test
+      cerr << "Elasped time = ";                               // lap timer
+      cout << timer.lap( ) << endl;
+      break;
+    case 12:
+      timer.start( );                                          // start timer
+      clientDuplex( sock, MAX, message );                      // actual test
+      cerr << "Elasped time = ";                               // lap timer
+      cout << timer.lap( ) << endl;
+      break;
+    case 13:
+      clientCoalesce( sock, MAX, message );                    // actual test
+      break;
+    case 14:
+      clientCompress( sock, MAX, message );                    // actual test
+      break;
+    case 15:
+      clientSeal( sock, MAX, message );                        // actual test
+      break;
+    case 16:
+      timer.start( );                                          // start timer
+      clientMulticast( MAX, message );                         // actual test
+      cerr << "Elasped time = ";                               // lap timer
+      cout << timer.lap( ) << endl;
+      break;
+    case 17:
+      timer.start( );                                          // start timer
+      clientFountain( MAX, message );                          // actual test
+      cerr << "Elasped time = ";                               // lap timer
+      cout << timer.lap( ) << endl;
+      break;
+    case 18:
+      clientNack( sock, MAX, message );                        // actual test
+      break;
+    case 19:
+      clientMultipath( argv[1], MAX, message );                // actual test
+      break;
+    case 20:
+      clientHarq( argv[1], MAX, message );                     // actual test
+      break;
+    case 21:
+      clientScavenger( sock, argv[1], MAX, message );          // actual test
+      break;
+    case 22:
+      clientEcn( sock, MAX, message );                         // actual test
+      break;
+    case 23:
+      clientStamp( sock, MAX, message );                       // actual test
+      break;
+    case 24:
+      clientBandwidth( sock, MAX, message );                   // actual test
+      break;
+    case 25:
+      clientWarm( sock, SHORT, message );                      // actual test
+      break;
     default:
       cerr << "no such test case" << endl;
       break;
     }
   }
   if ( myPart == SERVER ) {
+    int last = MAX;                     // messages in the test's last pass
     switch( testNumber ) {
     case 1:
       serverUnreliable( sock, MAX, message );
@@ -101,6 +325,81 @@ int main( int argc, char *argv[] ) {
       for ( int windowSize = 1; windowSize <= MAXWIN; windowSize++ )
 	serverEarlyRetrans( sock, MAX, message, windowSize );
       break;
+    case 4:                                  // nothing to receive
+    case 5:                                  // the bound socket just drops
+      break;
+    case 6: {
+      ShmSocket shm( PORT, true );          // offer rings to the client
+      for ( int windowSize = 1; windowSize <= MAXWIN; windowSize++ )
+	serverEarlyRetrans( shm, MAX, message, windowSize );
+      break;
+    }
+    case 7:                                  // the bound socket just drops
+      break;
+    case 8: {
+      EventLoop loop;                       // drives every connection
+      Connection *conns[CONNS];
+      for ( int i = 0; i < CONNS; i++ ) {
+	conns[i] = new Connection( loop, PORT + 1 + i, MAXWIN / 3 );
+	loop.spawn( serverAsync( *conns[i], MAX / CONNS ) );
+      }
+      loop.run( );
+      for ( int i = 0; i < CONNS; i++ )
+	delete conns[i];
+      break;
+    }
+    case 9:
+      serverDeadline( sock, MAX, message );
+      break;
+    case 10:
+      serverUnordered( sock, MAX, message );
+      break;
+    case 11:
+      serverStreams( sock, MAX, message );
+      break;
+    case 12:
+      serverDuplex( sock, MAX, message );
+      break;
+    case 13:
+      serverCoalesce( sock, MAX, message );
+      break;
+    case 14:
+      serverCompress( sock, MAX, message );
+      break;
+    case 15:
+      serverSeal( sock, MAX, message );
+      break;
+    case 16:
+      serverMulticast( MAX, message );
+      break;
+    case 17:
+      serverFountain( MAX, message );
+      break;
+    case 18:
+      serverNack( sock, MAX, message );
+      break;
+    case 19:
+      serverMultipath( MAX, message );
+      break;
+    case 20:
+      serverHarq( MAX, message );
+      break;
+    case 21:
+      serverScavenger( sock, MAX, message );
+      break;
+    case 22:
+      serverEcn( sock, MAX, message );
+      break;
+    case 23:
+      serverStamp( sock, MAX, message );
+      break;
+    case 24:
+      serverEarlyRetrans( sock, MAX, message, MAXWIN );
+      break;
+    case 25:
+      serverWarm( sock, SHORT, message );
+      last = SHORT;
+      break;
     default:
       cerr << "no such test case" << endl;
       break;
@@ -111,7 +410,9 @@ int main( int argc, char *argv[] ) {
     cerr << "server ending..." << endl;
     for ( int i = 0; i < 10; i++ ) {
       sleep( 1 );
-      int ack = MAX - 1;
+      AckHeader ack;
+      ack.ack = last;                 // the next sequence number expected
+      ack.flags = FRAME_ACK;
       sock.ackTo( (char *)&ack, sizeof( ack ) );
     }
   }
@@ -143,3 +444,884 @@ void serverUnreliable( UdpSocket &sock, const int max, int message[] ) {
     cerr << message[0] << endl;                     // print out message
   }
 }
+
+// Test 4: per-packet cost of modulo versus power-of-two sequence arithmetic --
+void benchSeqArithmetic( const int max ) {
+  cerr << "client: sequence arithmetic benchmark:" << endl;
+
+  Timer timer;           // define a timer
+  volatile int sink = 0; // keeps the compiler from discarding the loops
+
+  for ( int windowSize = 1; windowSize <= MAXWIN; windowSize++ ) {
+    int ring = windowSize + 1;          // the former queue modulus
+    int seqRange = windowSize * 2 + 1;  // the former sequence modulus
+    int acc = 0;
+
+    // each pass takes frame n against a window base b a few frames behind
+    // it and finds n + 1's queue slot, whether n is in the window and how
+    // far n is past b: the former code in sequence numbers modulo seqRange
+    timer.start( );
+    for ( int loop = 0; loop < LOOP; loop++ )
+      for ( int n = 0; n < max; n++ ) {
+	int b = n - ( n & 7 );
+	int slot = ( n + 1 ) % ring;                             // queue back
+	int seq = n % seqRange, base = b % seqRange;             // message[0]
+	int ahead = ( seq - base + seqRange ) % seqRange;
+	acc += slot + ( ahead < windowSize ) + ahead;            // ack check
+      }
+    long modulo = timer.lap( );
+    sink = sink + acc;
+
+    // the same operations on the same n and b in the power-of-two space
+    SeqSpace space( windowSize );
+    acc = 0;
+    timer.start( );
+    for ( int loop = 0; loop < LOOP; loop++ )
+      for ( uint32_t n = 0; n < (uint32_t)max; n++ ) {
+	uint32_t b = n - ( n & 7 );
+	int slot = space.slot( n + 1 );                          // queue back
+	acc += slot + SeqSpace::inWindow( n, b, windowSize )     // ack check
+	  + SeqSpace::diff( n, b );
+      }
+    long mask = timer.lap( );
+    sink = sink + acc;
+
+    // report nanoseconds per message for each implementation
+    cerr << "Window size = ";
+    cout << windowSize << " ";
+    cerr << "modulo ns/msg = ";
+    cout << modulo * 1000.0 / ( (long)max * LOOP ) << " ";
+    cerr << "mask ns/msg = ";
+    cout << mask * 1000.0 / ( (long)max * LOOP ) << endl;
+  }
+}
+
+// Test 5: send rate of unconnected versus connected datagrams ----------------
+void benchConnected( UdpSocket &sock, const int max, int message[] ) {
+  cerr << "client: connected send benchmark:" << endl;
+
+  Timer timer;           // define a timer
+  long total = (long)max * LOOP;
+
+  // every sendto( ) carries the destination and looks up its route
+  timer.start( );
+  for ( long i = 0; i < total; i++ ) {
+    message[0] = i;
+    sock.sendTo( ( char * )message, MSGSIZE );
+  }
+  long unconnected = timer.lap( );
+
+  // the kernel keeps the route of a connected socket
+  if ( sock.connectDest( ) == false )
+    return;
+  timer.start( );
+  for ( long i = 0; i < total; i++ ) {
+    message[0] = i;
+    sock.sendTo( ( char * )message, MSGSIZE );
+  }
+  long connected = timer.lap( );
+
+  // report packets per second for each mode
+  cerr << "unconnected pps = ";
+  cout << total * 1000000 / unconnected << " ";
+  cerr << "connected pps = ";
+  cout << total * 1000000 / connected << endl;
+}
+
+// Test 7: send rate of the socket path versus AF_XDP -------------------------
+void benchXdp( UdpSocket &sock, XdpSocket &xdp, const int max, 
+	       int message[] ) {
+  cerr << "client: AF_XDP send benchmark:" << endl;
+
+  Timer timer;           // define a timer
+  long total = (long)max * LOOP;
+  const int batch = 32;  // messages per sendBatch( )
+  static char msgs[batch * MSGSIZE];
+  int sizes[batch];
+
+  // one sendto( ) through the whole stack per datagram
+  timer.start( );
+  for ( long i = 0; i < total; i++ ) {
+    message[0] = i;
+    sock.sendTo( ( char * )message, MSGSIZE );
+  }
+  long socket = timer.lap( );
+
+  // one UMEM frame and one wakeup per datagram; retry while the ring is full
+  timer.start( );
+  for ( long i = 0; i < total; i++ ) {
+    message[0] = i;
+    while ( xdp.sendTo( ( char * )message, MSGSIZE ) < 0 );
+  }
+  long single = timer.lap( );
+
+  // batch UMEM frames behind a single wakeup
+  for ( int i = 0; i < batch; i++ )
+    sizes[i] = MSGSIZE;
+  timer.start( );
+  for ( long i = 0; i < total; ) {
+    *(int *)msgs = i;
+    i += xdp.sendBatch( msgs, MSGSIZE, sizes, batch );
+  }
+  long batched = timer.lap( );
+
+  // report packets per second for each path
+  cerr << "socket pps = ";
+  cout << total * 1000000 / socket << " ";
+  cerr << "xdp pps = ";
+  cout << total * 1000000 / single << " ";
+  cerr << "xdp batch pps = ";
+  cout << total * 1000000 / batched << endl;
+}
+
+// Test 8: client coroutine, one of CONNS sharing a thread --------------------
+Task clientAsync( Connection &conn, const int max, int &retransmits ) {
+  int message[MSGSIZE/4];
+
+  // each send resumes as soon as the window has room
+  for ( int i = 0; i < max; i++ ) {
+    message[0] = i;
+    co_await conn.send( ( char * )message, PAYLOADSIZE );
+  }
+  co_await conn.flush( );
+  retransmits += conn.retransmits( );
+}
+
+// Test 8: server coroutine, one of CONNS sharing a thread --------------------
+Task serverAsync( Connection &conn, const int max ) {
+  int message[MSGSIZE/4];
+
+  // each recv resumes with the next message in order
+  for ( int i = 0; i < max; i++ )
+    co_await conn.recv( ( char * )message );
+  co_await conn.linger( 100000 );       // re-ack until the client has stopped
+}
+
+// Test 9: client sends through LOSS, first reliably, then with deadlines -----
+void clientDeadline( UdpSocket &sock, const int max, int message[] ) {
+  LossySocket<UdpSocket> lossy( sock, LOSS );
+  Timer timer;           // define a timer
+
+  for ( long lifetime = 0; lifetime <= LIFETIME; lifetime += LIFETIME ) {
+    SenderEngine<SelectiveRepeat, CumulativeAck, FixedWindow, TimerClock,
+		 LossySocket<UdpSocket> > engine( lossy, MAXWIN );
+    timer.start( );                                            // start timer
+    int retransmits = engine.transfer( max, message, lifetime ); // actual test
+    cerr << "Lifetime = ";                                     // lap timer
+    cout << lifetime << " ";
+    cerr << "Elasped time = ";
+    cout << timer.lap( ) << endl;
+    cerr << "retransmits = " << retransmits;
+    cerr << " abandoned = " << engine.abandoned( ) << endl;
+  }
+}
+
+// Test 9: server receives both transfers, counting what was skipped ----------
+void serverDeadline( UdpSocket &sock, const int max, int message[] ) {
+  for ( int pass = 0; pass < 2; pass++ ) {
+    ReceiverEngine<SelectiveRepeat> engine( sock, MAXWIN );
+    engine.transfer( max, message );
+    cerr << "skipped = " << engine.skipped( ) << endl;
+  }
+}
+
+// Test 10: client sends through LOSS twice, stamping each message -----------
+void clientUnordered( UdpSocket &sock, const int max, int message[] ) {
+  LossySocket<UdpSocket> lossy( sock, LOSS );
+
+  for ( int pass = 0; pass < 2; pass++ ) {
+    SenderEngine<SelectiveRepeat, CumulativeAck, FixedWindow, TimerClock,
+		 LossySocket<UdpSocket> > engine( lossy, MAXWIN );
+    for ( int i = 0; i < max; i++ ) {
+      while ( engine.canSend( ) == false ) {
+	engine.checkTimeout( );
+	engine.ackAdvance( );
+      }
+      long sent = TimerClock::now( );     // read by a server on this host
+      memcpy( message, &sent, sizeof( sent ) );
+      engine.send( (char *)message, PAYLOADSIZE );
+      engine.ackAdvance( );
+    }
+    engine.flush( );
+    cerr << "retransmits = " << engine.retransmits( ) << endl;
+  }
+}
+
+// Test 10: server delivers in order, then unordered, timing each message ----
+template<class Arq>
+static void serverDelivery( UdpSocket &sock, const int max, int message[] ) {
+  ReceiverEngine<Arq> engine( sock, MAXWIN );
+  long total = 0, worst = 0;
+  for ( int received = 0; received < max; ) {
+    engine.receive( );
+    while ( engine.deliver( (char *)message ) >= 0 ) {
+      long sent;
+      memcpy( &sent, message, sizeof( sent ) );
+      long delay = TimerClock::now( ) - sent;
+      total += delay;
+      worst = ( delay > worst ) ? delay : worst;
+      received++;
+    }
+  }
+  cerr << "Mean delay = ";
+  cout << total / max << " ";
+  cerr << "Worst delay = ";
+  cout << worst << endl;
+}
+
+void serverUnordered( UdpSocket &sock, const int max, int message[] ) {
+  serverDelivery<SelectiveRepeat>( sock, max, message );
+  serverDelivery<UnorderedRepeat>( sock, max, message );
+}
+
+// Test 11: client writes STREAMS streams through LOSS, stamping each message
+void clientStreams( UdpSocket &sock, const int max, int message[] ) {
+  LossySocket<UdpSocket> lossy( sock, LOSS );
+  StreamSender<FixedWindow, TimerClock, LossySocket<UdpSocket> >
+    sender( lossy, MAXWIN, STREAMS );
+  int left[STREAMS];                     // messages each stream has to write
+
+  for ( int s = 0; s < STREAMS; s++ ) {
+    sender.setWeight( s, s + 1 );
+    left[s] = max / STREAMS;
+  }
+  for ( int written = 0; written < max / STREAMS * STREAMS; ) {
+    for ( int s = 0; s < STREAMS; s++ ) {
+      long sent = TimerClock::now( );     // read by a server on this host
+      memcpy( message, &sent, sizeof( sent ) );
+      if ( left[s] > 0 && sender.write( s, (char *)message, STREAMPAYLOAD ) ) {
+	left[s]--;
+	written++;
+      }
+    }
+    sender.pump( );
+  }
+  sender.flush( );
+  cerr << "retransmits = " << sender.retransmits( ) << endl;
+}
+
+// Test 11: server reads every stream, timing when each one completes --------
+void serverStreams( UdpSocket &sock, const int max, int message[] ) {
+  StreamReceiver<> receiver( sock, MAXWIN, STREAMS );
+  int  count[STREAMS] = { 0 };
+  long total[STREAMS] = { 0 };
+  long start = 0;
+
+  for ( int received = 0; received < max / STREAMS * STREAMS; ) {
+    receiver.receive( );
+    start = ( start == 0 ) ? TimerClock::now( ) : start;
+    for ( int s = 0; s < STREAMS; s++ ) {
+      while ( receiver.read( s, (char *)message ) >= 0 ) {
+	long sent;
+	memcpy( &sent, message, sizeof( sent ) );
+	total[s] += TimerClock::now( ) - sent;
+	received++;
+	if ( ++count[s] == max / STREAMS ) {
+	  cerr << "Stream = ";
+	  cout << s << " ";
+	  cerr << "Finished = ";
+	  cout << TimerClock::now( ) - start << " ";
+	  cerr << "Mean delay = ";
+	  cout << total[s] / count[s] << endl;
+	}
+      }
+    }
+  }
+  receiver.linger( LINGER );            // re-ack until the client is done
+  cerr << "grants sent = " << receiver.grants( ) << endl;
+}
+
+// Test 12: client keeps a window of requests outstanding, counting replies --
+void clientDuplex( UdpSocket &sock, const int max, int message[] ) {
+  DuplexSession<> session( sock, MAXWIN );
+  int sent = 0;
+
+  for ( int answered = 0; answered < max; ) {
+    if ( sent < max && session.canSend( ) ) {
+      session.send( (char *)message, DUPLEXPAYLOAD );
+      sent++;
+    }
+    while ( session.deliver( (char *)message ) >= 0 )
+      answered++;
+    session.step( );
+  }
+  session.flush( );
+  cerr << "retransmits = " << session.retransmits( ) << endl;
+  cerr << "Standalone acks = ";
+  cout << session.acks( ) << " ";
+  cerr << "Piggybacked acks = ";
+  cout << session.piggybacks( ) << endl;
+}
+
+// Test 12: server answers each request, its acks riding on the replies ------
+void serverDuplex( UdpSocket &sock, const int max, int message[] ) {
+  DuplexSession<> session( sock, MAXWIN );
+
+  // reply to wherever the first request came from
+  int length = sock.recvFrom( (char *)message, MSGSIZE );
+  sock.connectSrc( );
+  session.dispatch( (char *)message, length );
+  for ( int answered = 0; answered < max; ) {
+    while ( session.canSend( ) &&
+	    ( length = session.deliver( (char *)message ) ) >= 0 ) {
+      session.send( (char *)message, length );
+      answered++;
+    }
+    session.step( );
+  }
+  session.flush( );
+  cerr << "Standalone acks = ";
+  cout << session.acks( ) << " ";
+  cerr << "Piggybacked acks = ";
+  cout << session.piggybacks( ) << endl;
+}
+
+// Test 13: client writes SMALL messages, flushing each, then coalescing ----
+void clientCoalesce( UdpSocket &sock, const int max, int message[] ) {
+  Timer timer;           // define a timer
+
+  for ( int pass = 0; pass < 2; pass++ ) {
+    SenderEngine<GoBackN> engine( sock, MAXWIN );
+    Coalescer<SenderEngine<GoBackN> > coalescer( engine );
+    timer.start( );                                            // start timer
+    for ( int i = 0; i < max; i++ ) {
+      message[0] = i;
+      coalescer.write( (char *)message, SMALL );
+      if ( pass == 0 )
+	coalescer.flush( );              // a frame for every message
+      else
+	coalescer.poll( );
+    }
+    coalescer.flush( );
+    engine.flush( );
+    cerr << "Frames = ";                                       // lap timer
+    cout << engine.nextSequence( ) << " ";
+    cerr << "Elasped time = ";
+    cout << timer.lap( ) << endl;
+  }
+}
+
+// Test 13: server reads back every small message of both passes -------------
+void serverCoalesce( UdpSocket &sock, const int max, int message[] ) {
+  for ( int pass = 0; pass < 2; pass++ ) {
+    ReceiverEngine<SelectiveRepeat> engine( sock, MAXWIN );
+    RecordReader<ReceiverEngine<SelectiveRepeat> > reader( engine );
+    for ( int i = 0; i < max; i++ ) {
+      while ( reader.read( (char *)message ) < 0 )
+	engine.receive( );
+    }
+    cerr << "Frames = " << engine.expected( ) << endl;
+  }
+}
+
+// Test 14: client sends compressible data plain, then compressed, then -----
+//          sends random data compressed to watch compression switch off
+void clientCompress( UdpSocket &sock, const int max, int message[] ) {
+  const char *pass[] = { "plain", "compressed", "random" };
+  Timer timer;           // define a timer
+  unsigned seed = 432;
+
+  for ( int p = 0; p < 3; p++ ) {
+    for ( int i = 0; i < MSGSIZE / 4; i++ )    // text-like, or noise
+      message[i] = ( p < 2 ) ? i % 16 : rand_r( &seed );
+    CompressSocket<UdpSocket> lz4( sock, p > 0 );
+    SenderEngine<GoBackN, CumulativeAck, FixedWindow, TimerClock,
+		 CompressSocket<UdpSocket> > engine( lz4, MAXWIN );
+    timer.start( );                                            // start timer
+    engine.transfer( max, message );                           // actual test
+    cerr << pass[p] << ": Elasped time = ";                    // lap timer
+    cout << timer.lap( ) << " ";
+    cerr << "Bytes on wire = ";
+    cout << lz4.wire( ) << " ";
+    cerr << "Compressing = ";
+    cout << lz4.compressing( ) << endl;
+  }
+}
+
+// Test 14: server decompresses whatever arrives compressed, in all passes --
+void serverCompress( UdpSocket &sock, const int max, int message[] ) {
+  CompressSocket<UdpSocket> lz4( sock );
+  for ( int p = 0; p < 3; p++ ) {
+    ReceiverEngine<SelectiveRepeat, CumulativeAck, TimerClock,
+		   CompressSocket<UdpSocket> > engine( lz4, MAXWIN );
+    engine.transfer( max, message );
+  }
+}
+
+// Test 15: key both sides share; a real deployment would agree on one ------
+static const unsigned char sealKey[SEALKEY] = {
+  0x43, 0x53, 0x53, 0x34, 0x33, 0x32, 0x2d, 0x70, 0x72, 0x6f, 0x6a, 0x65,
+  0x63, 0x74, 0x32, 0x2d, 0x73, 0x65, 0x61, 0x6c, 0x2d, 0x6b, 0x65, 0x79,
+  0x2d, 0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36 };
+
+template<class Transport>
+static void sendSealed( Transport &sock, const int max, int message[] ) {
+  SenderEngine<GoBackN, CumulativeAck, FixedWindow, TimerClock, Transport>
+    engine( sock, MAXWIN );
+  for ( int i = 0; i < max; i++ ) {
+    while ( engine.canSend( ) == false ) {
+      engine.checkTimeout( );
+      engine.ackAdvance( );
+    }
+    engine.send( (char *)message, SEALPAYLOAD );
+    engine.ackAdvance( );
+  }
+  engine.flush( );
+}
+
+// Test 15: client times sealing and opening alone, then sends plain, then --
+//          sealed with each cipher
+void clientSeal( UdpSocket &sock, const int max, int message[] ) {
+  const char *name[] = { "AES-256-GCM", "ChaCha20-Poly1305" };
+  char sealed[MSGSIZE], opened[MSGSIZE];
+  Timer timer;           // define a timer
+
+  for ( int c = 0; c < 2; c++ ) {
+    Sealer sealer( sealKey, INITIATOR, (SealCipher)c );
+    Sealer opener( sealKey, RESPONDER, (SealCipher)c );
+    timer.start( );
+    for ( int i = 0; i < max; i++ )
+      sealer.seal( (char *)message, PAYLOADSIZE - SEALOVERHEAD, sealed );
+    long seal = timer.lap( );
+    opener.open( sealed, PAYLOADSIZE, opened );   // key the peer's session
+    timer.start( );                 // replays, dropped once the tag checks
+    for ( int i = 0; i < max; i++ )
+      opener.open( sealed, PAYLOADSIZE, opened );
+    long open = timer.lap( );
+    cerr << name[c] << ": nsec per seal = ";
+    cout << seal * 1000.0 / max << " ";
+    cerr << "nsec per open = ";
+    cout << open * 1000.0 / max << endl;
+  }
+
+  timer.start( );                                              // start timer
+  sendSealed( sock, max, message );                            // actual test
+  cerr << "plain: Elasped time = ";                            // lap timer
+  cout << timer.lap( ) << endl;
+  for ( int c = 0; c < 2; c++ ) {
+    SealSocket<UdpSocket> sealedSock( sock, sealKey, INITIATOR,
+				      (SealCipher)c );
+    timer.start( );                                            // start timer
+    sendSealed( sealedSock, max, message );                    // actual test
+    cerr << name[c] << ": Elasped time = ";                    // lap timer
+    cout << timer.lap( ) << endl;
+  }
+}
+
+// Test 15: server receives plain, then sealed with each cipher --------------
+void serverSeal( UdpSocket &sock, const int max, int message[] ) {
+  ReceiverEngine<SelectiveRepeat> engine( sock, MAXWIN );
+  engine.transfer( max, message );
+  for ( int c = 0; c < 2; c++ ) {
+    SealSocket<UdpSocket> sealedSock( sock, sealKey, RESPONDER,
+				      (SealCipher)c );
+    ReceiverEngine<SelectiveRepeat, CumulativeAck, TimerClock,
+		   SealSocket<UdpSocket> > engine( sealedSock, MAXWIN );
+    engine.transfer( max, message );
+    cerr << "forgeries = " << sealedSock.forgeries( ) << endl;
+  }
+}
+
+// Test 16: client multicasts through LOSS, repairing what is NACKed --------
+void clientMulticast( const int max, int message[] ) {
+  McastSocket group( PORT + 20, GROUP );  // every member shares this port
+  LossySocket<McastSocket> lossy( group, LOSS );
+  McastSender<TimerClock, LossySocket<McastSocket> >
+    sender( lossy, HISTORY, 20 );
+
+  for ( int i = 0; i < max; i++ )
+    sender.send( (char *)message, PAYLOADSIZE );
+  sender.linger( 1000000 );              // until a second passes NACK-free
+  cerr << "NACKs heard = ";
+  cout << sender.nacked( ) << " ";
+  cerr << "Frames repaired = ";
+  cout << sender.repaired( ) << endl;
+}
+
+// Test 16: server forks RECEIVERS receivers, all joined to the group -------
+void serverMulticast( const int max, int message[] ) {
+  for ( int r = 0; r < RECEIVERS; r++ ) {
+    if ( r < RECEIVERS - 1 && fork( ) != 0 )
+      continue;                           // the parent forks the next
+    McastSocket group( PORT + 20, GROUP );
+    McastReceiver<> receiver( group, HISTORY, 432 + r );
+    receiver.transfer( max, message );
+    cerr << "Receiver = ";
+    cout << r << " ";
+    cerr << "NACKs sent = ";
+    cout << receiver.nacks( ) << " ";
+    cerr << "NACKs suppressed = ";
+    cout << receiver.suppressions( ) << " ";
+    cerr << "Skipped = ";
+    cout << receiver.skipped( ) << endl;
+    if ( r < RECEIVERS - 1 )
+      exit( 0 );                          // a child is done
+  }
+  while ( wait( NULL ) > 0 ) ;            // for every child
+}
+
+// Test 17: client streams LT symbols of a max-symbol object to the group ---
+void clientFountain( const int max, int message[] ) {
+  McastSocket group( PORT + 21, GROUP );
+  LossySocket<McastSocket> lossy( group, CODEDLOSS );
+  vector<char> object( (long)max * SYMBOLSIZE );
+
+  for ( int i = 0; i < max; i++ ) {    // symbol i leads with i
+    message[0] = i;
+    memcpy( &object[(long)i * SYMBOLSIZE], message, SYMBOLSIZE );
+  }
+  FountainSender<TimerClock, LossySocket<McastSocket> >
+    sender( lossy, &object[0], object.size( ), 20 );
+  sender.run( RECEIVERS, 2 * max );
+  cerr << "Symbols sent = ";
+  cout << sender.sent( ) << " ";
+  cerr << "Receivers done = ";
+  cout << sender.completions( ) << " ";
+  cerr << "Encode usec/symbol = ";
+  cout << (double)sender.encodeTime( ) / sender.sent( ) << endl;
+}
+
+// Test 17: server forks RECEIVERS receivers, each decoding on its own ------
+void serverFountain( const int max, int message[] ) {
+  for ( int r = 0; r < RECEIVERS; r++ ) {
+    if ( r < RECEIVERS - 1 && fork( ) != 0 )
+      continue;                           // the parent forks the next
+    McastSocket group( PORT + 21, GROUP );
+    FountainReceiver<> receiver( group, 432 + r );
+    const char *object = receiver.transfer( );
+    receiver.linger( 100000 );            // until the sender has stopped
+    int corrupt = 0;
+    if ( receiver.symbols( ) != max )
+      cerr << "Object of " << receiver.symbols( ) << " symbols, not " << max
+	   << endl;
+    for ( int i = 0; i < receiver.symbols( ); i++ ) {
+      memcpy( message, object + (long)i * SYMBOLSIZE, SYMBOLSIZE );
+      corrupt += message[0] != i;         // symbol i leads with i
+    }
+    cerr << "Receiver = ";
+    cout << r << " ";
+    cerr << "Symbols received = ";
+    cout << receiver.received( ) << " ";
+    cerr << "Decode usec/symbol = ";
+    cout << (double)receiver.decodeTime( ) / receiver.received( ) << " ";
+    cerr << "Corrupt = ";
+    cout << corrupt << endl;
+    if ( r < RECEIVERS - 1 )
+      exit( 0 );                          // a child is done
+  }
+  while ( wait( NULL ) > 0 ) ;            // for every child
+}
+
+// Test 18: client sends through LOSS twice, timing each pass ---------------
+void clientNack( UdpSocket &sock, const int max, int message[] ) {
+  LossySocket<UdpSocket> lossy( sock, LOSS );
+  Timer timer;
+
+  for ( int pass = 0; pass < 2; pass++ ) {
+    SenderEngine<SelectiveRepeat, CumulativeAck, FixedWindow, TimerClock,
+		 LossySocket<UdpSocket> > engine( lossy, MAXWIN );
+    timer.start( );
+    int retransmits = engine.transfer( max, message );
+    cerr << "Elasped time = ";
+    cout << timer.lap( ) << " ";
+    cerr << "retransmits = ";
+    cout << retransmits << endl;
+  }
+}
+
+// Test 18: server acks every frame, then NACKs gaps and acks half windows --
+template<class Ack>
+static void serverAcking( UdpSocket &sock, const int max, int message[] ) {
+  ReceiverEngine<SelectiveRepeat, Ack> engine( sock, MAXWIN );
+  engine.transfer( max, message );
+  engine.linger( LINGER );              // until the next pass or quiet
+  cerr << "Acks sent = ";
+  cout << engine.acks( ) << " ";
+  cerr << "NACKs sent = ";
+  cout << engine.nacks( ) << endl;
+}
+
+void serverNack( UdpSocket &sock, const int max, int message[] ) {
+  serverAcking<CumulativeAck>( sock, max, message );
+  serverAcking<NackAck>( sock, max, message );
+}
+
+// Test 19: client sends on one port, then striped across PATHS ports -------
+void clientMultipath( char server[], const int max, int message[] ) {
+  Timer timer;
+
+  for ( int count = 1; count <= PATHS; count += PATHS - 1 ) {
+    MultipathSocket<> paths( PORT + 30 + count, count, MAXWIN );
+    if ( paths.setDestAddress( server ) == false )
+      return;
+    SenderEngine<SelectiveRepeat, CumulativeAck, MultipathWindow<>,
+		 TimerClock, MultipathSocket<> > engine( paths, MAXWIN );
+    engine.controller( ).attach( paths );   // send only while a path has room
+    timer.start( );
+    int retransmits = engine.transfer( max, message );
+    cerr << "Paths = ";
+    cout << count << " ";
+    cerr << "Elasped time = ";
+    cout << timer.lap( ) << " ";
+    cerr << "retransmits = ";
+    cout << retransmits << endl;
+    for ( int p = 0; p < count; p++ ) {
+      cerr << "  Path = ";
+      cout << "  " << p << " ";
+      cerr << "Frames = ";
+      cout << paths.frames( p ) << " ";
+      cerr << "Losses = ";
+      cout << paths.losses( p ) << " ";
+      cerr << "SRTT = ";
+      cout << paths.srtt( p ) << " ";
+      cerr << "Window = ";
+      cout << paths.cwnd( p ) << endl;
+    }
+  }
+}
+
+// Test 19: server receives on one port, then on every striped port, -------
+// opening those before it lingers on the first, so it holds them first
+void serverMultipath( const int max, int message[] ) {
+  MultipathSocket<> *paths = new MultipathSocket<>( PORT + 31, 1, MAXWIN );
+  for ( int count = 1; count <= PATHS; count += PATHS - 1 ) {
+    ReceiverEngine<SelectiveRepeat, CumulativeAck, TimerClock,
+		   MultipathSocket<> > engine( *paths, MAXWIN );
+    engine.transfer( max, message );
+    MultipathSocket<> *next = NULL;
+    if ( count == 1 )
+      next = new MultipathSocket<>( PORT + 30 + PATHS, PATHS, MAXWIN );
+    engine.linger( LINGER );            // re-ack until the client moves on
+    delete paths;
+    paths = next;
+  }
+}
+
+// Test 20: client interleaves 1, 2, 4, ... CHANNELS stop-and-wait channels --
+void clientHarq( char server[], const int max, int message[] ) {
+  Timer timer;
+
+  for ( int channels = 1; channels <= CHANNELS; channels *= 2 ) {
+    UdpSocket sock( PORT + 40 + channels ); // a fresh port for each run
+    if ( sock.setDestAddress( server ) == false )
+      return;
+    HarqSender<> sender( sock, channels );
+    timer.start( );
+    int retransmits = sender.transfer( max, message );
+    cerr << "Channels = ";
+    cout << channels << " ";
+    cerr << "Elasped time = ";
+    cout << timer.lap( ) << endl;
+    cerr << "retransmits = " << retransmits << endl;
+  }
+}
+
+// Test 20: server receives each run on its own port, opening the next -----
+// before it lingers on the last, so it holds that port before the client
+void serverHarq( const int max, int message[] ) {
+  UdpSocket *sock = new UdpSocket( PORT + 41 );
+  for ( int channels = 1; channels <= CHANNELS; channels *= 2 ) {
+    HarqReceiver<> receiver( *sock, channels );
+    receiver.transfer( max, message );
+    UdpSocket *next = NULL;
+    if ( channels * 2 <= CHANNELS )
+      next = new UdpSocket( PORT + 40 + channels * 2 );
+    receiver.linger( LINGER );          // re-ack until the client moves on
+    cerr << "blocked = " << receiver.blocked( ) << endl;
+    delete sock;
+    sock = next;
+  }
+}
+
+// Tests 21-25: client sends max messages of payload bytes through engine,
+// sampling its window and calling each( engine, sent, max ) after each send
+template<class Engine>
+static long sendControlled( Engine &engine, const int max, int message[],
+			    const char *name, int payload = PAYLOADSIZE,
+			    void (*each)( Engine &, int, int ) = NULL ) {
+  Timer timer;
+  long windows = 0;                       // sum of the window at each send
+
+  timer.start( );
+  for ( int i = 0; i < max; i++ ) {
+    while ( engine.canSend( ) == false ) {
+      engine.checkTimeout( );
+      engine.ackAdvance( );
+    }
+    windows += engine.controller( ).window( );
+    engine.send( (char *)message, payload );
+    engine.ackAdvance( );
+    if ( each != NULL )
+      each( engine, i + 1, max );
+  }
+  engine.flush( );
+  long elapsed = timer.lap( );
+  cerr << name << " Elasped time = ";
+  cout << elapsed << " ";
+  cerr << "retransmits = ";
+  cout << engine.retransmits( ) << " ";
+  cerr << "Mean window = ";
+  cout << (double)windows / max << endl;
+  return elapsed;
+}
+
+// Test 21: client sends with one congestion controller ---------------------
+template<class Cc, class Transport>
+static void clientControlled( Transport &sock, const int max, int message[],
+			      const char *name ) {
+  SenderEngine<SelectiveRepeat, CumulativeAck, Cc, TimerClock, Transport>
+    engine( sock, MAXWIN );
+  sendControlled( engine, max, message, name );
+}
+
+// Test 21: client sends at a fixed window, then as a LEDBAT scavenger, then
+// as a scavenger beside a fixed-window transfer forked onto another port
+void clientScavenger( UdpSocket &sock, char server[], const int max,
+		      int message[] ) {
+  clientControlled<FixedWindow>( sock, max, message, "Fixed:" );
+  clientControlled<LedbatWindow>( sock, max, message, "LEDBAT:" );
+  if ( fork( ) == 0 ) {
+    UdpSocket other( PORT + 60 );
+    if ( other.setDestAddress( server ) )
+      clientControlled<FixedWindow>( other, max, message, "Beside fixed:" );
+    exit( 0 );
+  }
+  clientControlled<LedbatWindow>( sock, max, message, "Beside LEDBAT:" );
+  wait( NULL );
+}
+
+// Test 21: server receives each transfer, the last two side by side -------
+void serverScavenger( UdpSocket &sock, const int max, int message[] ) {
+  for ( int pass = 0; pass < 3; pass++ ) {
+    if ( pass == 2 && fork( ) == 0 ) {
+      UdpSocket other( PORT + 60 );
+      ReceiverEngine<SelectiveRepeat> engine( other, MAXWIN );
+      engine.transfer( max, message );
+      engine.linger( LINGER );
+      exit( 0 );
+    }
+    ReceiverEngine<SelectiveRepeat> engine( sock, MAXWIN );
+    engine.transfer( max, message );
+    engine.linger( LINGER );            // until the next pass or quiet
+  }
+  wait( NULL );
+}
+
+// Test 22: client sends through a queue that marks past ECNQUEUE frames, ----
+// first ignoring the marks, then cutting its window in proportion to them
+void clientEcn( UdpSocket &sock, const int max, int message[] ) {
+  EcnMarker<> fixed( sock, ECNQUEUE );
+  clientControlled<FixedWindow>( fixed, max, message, "Fixed:" );
+  cerr << "  Marked = ";
+  cout << "  " << fixed.marked( ) << endl;
+
+  EcnMarker<> dctcp( sock, ECNQUEUE );
+  clientControlled<DctcpWindow>( dctcp, max, message, "DCTCP:" );
+  cerr << "  Marked = ";
+  cout << "  " << dctcp.marked( ) << endl;
+}
+
+// Test 22: server counts the marks on both transfers and echoes them -------
+void serverEcn( UdpSocket &sock, const int max, int message[] ) {
+  EcnSocket<> ecn( sock );
+  for ( int pass = 0; pass < 2; pass++ ) {
+    ReceiverEngine<SelectiveRepeat, CumulativeAck, TimerClock, EcnSocket<> >
+      engine( ecn, MAXWIN );
+    engine.transfer( max, message );
+    engine.linger( LINGER );            // until the next pass or quiet
+    cerr << "CE marks echoed = " << engine.marked( ) << endl;
+  }
+}
+
+// Test 23: client stamps every frame and splits each echo's round trip -----
+void clientStamp( UdpSocket &sock, const int max, int message[] ) {
+  StampSocket<UdpSocket> stamped( sock );
+  SenderEngine<SelectiveRepeat, CumulativeAck, FixedWindow, TimerClock,
+	       StampSocket<UdpSocket> > engine( stamped, MAXWIN );
+  sendControlled( engine, max, message, "Stamped:", STAMPPAYLOAD );
+
+  const OwdEstimator &owd = stamped.delays( );
+  cerr << "Echoes = ";
+  cout << owd.samples( ) << " ";
+  cerr << "Forward mean/min = ";
+  cout << owd.forward( ) << " " << owd.forwardMin( ) << " ";
+  cerr << "Reverse mean/min = ";
+  cout << owd.reverse( ) << " " << owd.reverseMin( ) << endl;
+  cerr << "Clock offset = ";
+  cout << owd.offset( ) << " ";
+  cerr << "Clock skew ppm = ";
+  cout << owd.skew( ) << endl;
+}
+
+// Test 23: server echoes the stamp of each frame in the next ack -----------
+void serverStamp( UdpSocket &sock, const int max, int message[] ) {
+  StampSocket<UdpSocket> stamped( sock );
+  ReceiverEngine<SelectiveRepeat, CumulativeAck, TimerClock,
+		 StampSocket<UdpSocket> > engine( stamped, MAXWIN );
+  engine.transfer( max, message );
+}
+
+// Test 24: client prints the live bandwidth estimates each quarter --------
+static void reportBandwidth( SenderEngine<SelectiveRepeat> &engine, int sent,
+			     int max ) {
+  if ( sent % ( max / 4 ) != 0 )
+    return;
+  cerr << "Sent = ";
+  cout << sent << " ";
+  cerr << "Delivery rate Mbps = ";
+  cout << engine.estimator( ).bandwidth( ) * 8 / 1e6 << " ";
+  cerr << "Packet pair Mbps = ";
+  cout << engine.estimator( ).pairBandwidth( ) * 8 / 1e6 << endl;
+}
+
+// Test 24: client reads the live bandwidth estimates as it sends ----------
+void clientBandwidth( UdpSocket &sock, const int max, int message[] ) {
+  SenderEngine<SelectiveRepeat> engine( sock, MAXWIN );
+
+  engine.estimator( ).probe( true );
+  long elapsed = sendControlled( engine, max, message, "Probed:", PAYLOADSIZE,
+				 reportBandwidth );
+  cerr << "Goodput Mbps = ";
+  cout << (double)max * MSGSIZE * 8 / elapsed << " ";
+  cerr << "Least RTT = ";
+  cout << engine.estimator( ).leastRtt( ) << endl;
+}
+
+// Test 25: client sends a short transfer cold, remembers the path, then ----
+// sends another that starts from what the first learned
+void clientWarm( UdpSocket &sock, const int max, int message[] ) {
+  PathCache cache( PATHCACHE );
+  struct sockaddr_storage server;
+
+  sock.getDestAddress( &server );
+  cache.forget( server );
+  for ( int pass = 0; pass < 2; pass++ ) {
+    SenderEngine<SelectiveRepeat, CumulativeAck, DctcpWindow> engine( sock,
+								      MAXWIN );
+    engine.followRtt( );                  // both passes adapt their RTO
+    bool warm = cache.warm( sock, engine );
+
+    cerr << "Start window = ";
+    cout << engine.controller( ).window( ) << " ";
+    cerr << "RTO = ";
+    cout << engine.timeout( ) << " ";
+    sendControlled( engine, max, message, warm ? "Warm:" : "Cold:" );
+
+    PathMetrics learned = cache.remember( sock, engine );
+    cerr << "  Stored SRTT/RTTVAR = ";
+    cout << "  " << learned.srtt << " " << learned.rttvar << " ";
+    cerr << "Bandwidth Mbps = ";
+    cout << learned.bandwidth * 8 / 1e6 << " ";
+    cerr << "Window = ";
+    cout << learned.window << endl;
+  }
+}
+
+// Test 25: server receives both short transfers -------------------------
+void serverWarm( UdpSocket &sock, const int max, int message[] ) {
+  for ( int pass = 0; pass < 2; pass++ ) {
+    ReceiverEngine<SelectiveRepeat> engine( sock, MAXWIN );
+    engine.transfer( max, message );
+    engine.linger( LINGER );            // until the next pass or quiet
+  }
+}